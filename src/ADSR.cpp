@@ -1,5 +1,7 @@
 #include "plugin.hpp"
 
+using simd::float_4;
+
 
 struct BefacoADSREnvelope {
 
@@ -21,19 +23,21 @@ struct BefacoADSREnvelope {
 
 	BefacoADSREnvelope() { };
 
-	void retrigger() {
+	// elapsed is the time since the (sub-sample) trigger, which the attack is advanced by
+	void retrigger(float elapsed = 0.f) {
 		stage = STAGE_ATTACK;
 		// get the linear value of the envelope
-		timeInCurrentStage = attackTime * std::pow(env, 1.0f / attackShape);
+		retriggerCurve.setShape(1.0f / attackShape);
+		timeInCurrentStage = attackTime * retriggerCurve.process(env) + elapsed;
 	}
 
-	void processTransitionsGateMode(const bool& gateHeld) {
+	void processTransitionsGateMode(const bool& gateHeld, float elapsed) {
 		if (gateHeld) {
 			// calculate stage transitions
 			switch (stage) {
 				case  STAGE_OFF: {
 					env = 0.0f;
-					timeInCurrentStage = 0.f;
+					timeInCurrentStage = elapsed;
 					stage = STAGE_ATTACK;
 					break;
 				}
@@ -56,7 +60,7 @@ struct BefacoADSREnvelope {
 				}
 				case STAGE_RELEASE: {
 					stage = STAGE_ATTACK;
-					timeInCurrentStage = attackTime * env;
+					timeInCurrentStage = attackTime * env + elapsed;
 					break;
 				}
 			}
@@ -129,6 +133,10 @@ struct BefacoADSREnvelope {
 	}
 
 	void evolveEnvelope(const float& sampleTime) {
+		attackCurve.setShape(attackShape);
+		decayCurve.setShape(decayShape);
+		releaseCurve.setShape(releaseShape);
+
 		switch (stage) {
 			case  STAGE_OFF: {
 				env = 0.0f;
@@ -136,13 +144,12 @@ struct BefacoADSREnvelope {
 			}
 			case STAGE_ATTACK: {
 				timeInCurrentStage += sampleTime;
-				env = std::min(timeInCurrentStage / attackTime, 1.f);
-				env = std::pow(env, attackShape);
+				env = attackCurve.process(timeInCurrentStage / attackTime);
 				break;
 			}
 			case STAGE_DECAY: {
 				timeInCurrentStage += sampleTime;
-				env = std::pow(1.f - std::min(1.f, timeInCurrentStage / decayTime), decayShape);
+				env = decayCurve.process(1.f - timeInCurrentStage / decayTime);
 				env = sustainLevel + (1.f - sustainLevel) * env;
 				break;
 			}
@@ -152,24 +159,32 @@ struct BefacoADSREnvelope {
 			}
 			case STAGE_RELEASE: {
 				timeInCurrentStage += sampleTime;
-				env = std::min(1.0f, timeInCurrentStage / releaseTime);
-				env = releaseValue * std::pow(1.0f - env, releaseShape);
+				env = releaseValue * releaseCurve.process(1.0f - timeInCurrentStage / releaseTime);
 				break;
 			}
 		}
 	}
 
-	void process(const float& sampleTime, const bool& gateHeld, const bool& triggerMode) {
+	// elapsed is the time since the gate went high, if that happened on this sample (zero otherwise)
+	void process(const float& sampleTime, const bool& gateHeld, const bool& triggerMode, float elapsed = 0.f) {
 
 		if (triggerMode) {
 			processTransitionsTriggerMode(gateHeld);
 		}
 		else {
-			processTransitionsGateMode(gateHeld);
+			processTransitionsGateMode(gateHeld, elapsed);
 		}
 
 		evolveEnvelope(sampleTime);
 	}
+
+private:
+	// curves are looked up from tables, which are only rebuilt when the shape changes
+	PowerCurveTable attackCurve;
+	PowerCurveTable decayCurve;
+	PowerCurveTable releaseCurve;
+	// inverse of the attack curve
+	PowerCurveTable retriggerCurve;
 };
 
 struct ADSR : Module {
@@ -213,8 +228,11 @@ struct ADSR : Module {
 	};
 
 	BefacoADSREnvelope envelope;
-	dsp::SchmittTrigger gateTrigger;
-	dsp::ClockDivider cvDivider;
+	// only the first lane is used
+	SubSampleTrigger_4 gateTrigger;
+	// shape and times are updated at control rate, sustain is also ramped in between so that sustain CV doesn't step
+	ControlRateDivider cvDivider;
+	ControlRateRamp<float> sustainLevel;
 	float shape;
 
 	static constexpr float minStageTime = 0.003f;  // in seconds
@@ -247,8 +265,6 @@ struct ADSR : Module {
 		configOutput(STAGE_DECAY_OUTPUT, "Decay stage");
 		configOutput(STAGE_SUSTAIN_OUTPUT, "Sustain stage");
 		configOutput(STAGE_RELEASE_OUTPUT, "Release stage");
-		
-		cvDivider.setDivision(16);
 	}
 
 	void process(const ProcessArgs& args) override {
@@ -267,23 +283,29 @@ struct ADSR : Module {
 			envelope.decayTime = convertCVToTimeInSeconds(decayCV);
 
 			const float sustainCV =  clamp(params[SUSTAIN_PARAM].getValue() + inputs[CV_SUSTAIN_INPUT].getVoltage() / 10.f, 0.f, 1.f);
-			envelope.sustainLevel = sustainCV;
+			cvDivider.setTarget(sustainLevel, sustainCV);
 
 			const float releaseCV =  clamp(params[RELEASE_PARAM].getValue() + inputs[CV_RELEASE_INPUT].getVoltage() / 10.f, 0.f, 1.f);
 			envelope.releaseTime = convertCVToTimeInSeconds(releaseCV);
 		}
 
-		const bool triggered = gateTrigger.process(rescale(params[MANUAL_TRIGGER_PARAM].getValue() * 10.f + inputs[TRIGGER_INPUT].getVoltage(), 0.1f, 2.f, 0.f, 1.f));
-		const bool gateOn = gateTrigger.isHigh() || params[MANUAL_TRIGGER_PARAM].getValue();
+		envelope.sustainLevel = sustainLevel.process();
+
+		const bool manualTrigger = params[MANUAL_TRIGGER_PARAM].getValue();
+		float_4 crossing;
+		const bool triggered = simd::movemask(gateTrigger.process(manualTrigger * 10.f + inputs[TRIGGER_INPUT].getVoltage(), crossing)) & 1;
+		const bool gateOn = (simd::movemask(gateTrigger.isHigh()) & 1) || manualTrigger;
 		const bool triggerMode = params[TRIGG_GATE_TOGGLE_PARAM].getValue() == 1;
+		// the attack starts from where the gate crossed the threshold, between samples (the button has no such position)
+		const float elapsed = (triggered && !manualTrigger) ? SubSampleTrigger_4::getTimeSinceCrossing(crossing, args.sampleTime)[0] : 0.f;
 
 		if (triggerMode) {
 			if (triggered) {
-				envelope.retrigger();
+				envelope.retrigger(elapsed);
 			}
 		}
 
-		envelope.process(args.sampleTime, gateOn, triggerMode);
+		envelope.process(args.sampleTime, gateOn, triggerMode, elapsed);
 
 		outputs[OUT_OUTPUT].setVoltage(envelope.env * 10.f);
 
@@ -4,29 +4,27 @@
 #define TRIGGER_TIME 0.001
 
 // a tempo/clock calculator that responds to pings - this sets the base tempo, multiplication/division of 
-// this tempo occurs in the BurstEngine
+// this tempo occurs in the BurstEngine. Time is counted in samples, so the tempo doesn't drift
 struct PingableClock {
 
-	dsp::Timer timer;                   // time the gap between pings
-	dsp::PulseGenerator clockTimer;     // counts down from tempo length to zero
-	dsp::BooleanTrigger clockExpiry;    // checks for when the clock timer runs out
+	SampleClock clock;                  // ticks at the tempo, and times the gap between pings
 
-	float pingDuration = 0.5f;          // used for calculating and updating tempo (default 2Hz / 120 bpm)
-	float tempo = 0.5f;                 // actual current tempo of clock
+	float sampleRate = 44100.f;
+	int64_t pingDuration = 22050;       // used for calculating and updating tempo (default 2Hz / 120 bpm)
+	int pulseSamples = 45;              // length of the tempo out pulse
 
 	PingableClock() {
-		clockTimer.trigger(tempo);
+		clock.period = pingDuration;
+		clock.restart();
 	}
 
-	void process(bool pingRecieved, float sampleTime) {
-		timer.process(sampleTime);
-
+	void process(bool pingRecieved) {
 		bool clockRestarted = false;
 
 		if (pingRecieved) {
 
 			bool tempoShouldBeUpdated = true;
-			float duration = timer.getTime();
+			const int64_t duration = clock.pulse();
 
 			// if the ping was unusually different to last time
 			bool outlier = duration > (pingDuration * 2) || duration < (pingDuration / 2);
@@ -39,99 +37,134 @@ struct PingableClock {
 			else {
 				pingDuration = duration;
 			}
-			timer.reset();
 
 			if (tempoShouldBeUpdated) {
 				// if the tempo should be updated, do so
-				tempo = pingDuration;
+				clock.period = std::max<int64_t>(pingDuration, 1);
 				clockRestarted = true;
 			}
 		}
 
 		// we restart the clock if a) a new valid ping arrived OR b) the current clock expired
-		clockRestarted = clockExpiry.process(!clockTimer.process(sampleTime)) || clockRestarted;
 		if (clockRestarted) {
-			clockTimer.reset();
-			clockTimer.trigger(tempo);
+			clock.restart();
 		}
+		clock.process();
+	}
+
+	void setSampleRate(float newSampleRate) {
+		// keep the tempo (in seconds)
+		const float ratio = newSampleRate / sampleRate;
+		clock.rescale(ratio);
+		pingDuration = std::round(pingDuration * ratio);
+		sampleRate = newSampleRate;
+		pulseSamples = std::ceil(TRIGGER_TIME * sampleRate);
+	}
+
+	// tempo, in samples
+	int64_t getTempo() const {
+		return clock.period;
 	}
 
 	bool isTempoOutHigh() {
 		// give a 1ms pulse as tempo out
-		return clockTimer.remaining > tempo - TRIGGER_TIME;
+		return clock.elapsed < pulseSamples;
 	}
 };
 
-// engine that generates a burst when triggered
+// engine that generates a burst when triggered. Event times are converted to sample offsets as they are scheduled, so
+// between events the engine only counts samples
 struct BurstEngine {
 
-	dsp::PulseGenerator eocOutput;      // for generating EOC trigger
-	dsp::PulseGenerator burstOutput;    // for generating triggers for each occurance of the burst
-	dsp::Timer burstTimer;              // for timing how far through the current burst we are
+	int burstPulseRemaining = 0;    // samples left of the trigger for the current occurance of the burst
+	int eocPulseRemaining = 0;      // samples left of the EOC trigger
+	int pulseSamples = std::ceil(TRIGGER_TIME * 44100.f);  // length of a trigger in samples (set on trigger)
 
-	float timings[MAX_REPETITIONS + 1] = {};        // store timings (calculated once on burst trigger)
+	int64_t samplesSinceTrigger = 0;    // how far through the current burst we are
+	int64_t nextEventSample = 0;        // when the next trigger (or EOC) fires, in samples since the burst was triggered
+
+	// fixed over course of burst: the time window (timeWindow / windowDivision samples), number of bursts and distribution
+	int64_t timeWindow = 0;
+	int windowDivision = 1;
+	float power = 1.f;
+	int numBursts = 1;
 
 	int triggersOccurred = 0;       // how many triggers have been
 	int triggersRequested = 0;      // how many bursts have been requested (fixed over course of burst)
 	bool active = true;             // is there a burst active
 	bool wasInhibited = false;      // was this burst inhibited (i.e. just the first trigger sent)
 
-	std::tuple<float, float, bool> process(float sampleTime) {
-
-		if (active) {
-			burstTimer.process(sampleTime);
-		}
+	std::tuple<float, float, bool> process() {
 
 		bool eocTriggered = false;
-		if (burstTimer.time > timings[triggersOccurred]) {
+		if (active && ++samplesSinceTrigger >= nextEventSample) {
 			if (triggersOccurred < triggersRequested) {
-				burstOutput.reset();
-				burstOutput.trigger(TRIGGER_TIME);
+				burstPulseRemaining = pulseSamples;
 			}
-			else if (triggersOccurred == triggersRequested) {
-				eocOutput.reset();
-				eocOutput.trigger(TRIGGER_TIME);
+			else {
+				eocPulseRemaining = pulseSamples;
 				active = false;
 				eocTriggered = true;
 			}
 			triggersOccurred++;
+
+			if (active) {
+				scheduleNextEvent();
+			}
 		}
 
-		const float burstOut = burstOutput.process(sampleTime);
+		const float burstOut = burstPulseRemaining > 0;
 		// NOTE: we don't get EOC if the burst was inhibited
-		const float eocOut = eocOutput.process(sampleTime) * !wasInhibited;
+		const float eocOut = (eocPulseRemaining > 0) * !wasInhibited;
+		burstPulseRemaining -= burstPulseRemaining > 0;
+		eocPulseRemaining -= eocPulseRemaining > 0;
 		return std::make_tuple(burstOut, eocOut, eocTriggered);
 	}
 
-	void trigger(int numBursts, int multDiv, float baseTimeWindow, float distribution, bool inhibitBurst, bool includeOriginalTrigger) {
+	// the next trigger fires on the first sample after its time (skewed by distribution), at most one event per sample
+	void scheduleNextEvent() {
+		int64_t time;
+		if (power == 1.f) {
+			// evenly spaced, so the exact rational time can be used
+			time = timeWindow * triggersOccurred / ((int64_t) windowDivision * numBursts);
+		}
+		else {
+			time = (double) timeWindow / windowDivision * std::pow((double) triggersOccurred / numBursts, power);
+		}
+		nextEventSample = std::max(time, samplesSinceTrigger + 1);
+	}
+
+	// baseTimeWindow is the tempo in samples
+	void trigger(int numBursts, int multDiv, int64_t baseTimeWindow, float distribution, bool inhibitBurst, bool includeOriginalTrigger,
+	             float sampleTime) {
 
 		active = true;
 		wasInhibited = inhibitBurst;
+		this->numBursts = numBursts;
+		pulseSamples = std::max((int) std::ceil(TRIGGER_TIME / sampleTime), 1);
 
 		// the window in which the burst fits is a multiple (or division) of the base tempo
 		int divisions = multDiv + (multDiv > 0 ? 1 : multDiv < 0 ? -1 : 0); 	// skip 2/-2
-		float actualTimeWindow = baseTimeWindow;
+		timeWindow = baseTimeWindow;
+		windowDivision = 1;
 		if (divisions > 0) {
-			actualTimeWindow = baseTimeWindow * divisions;
+			timeWindow = baseTimeWindow * divisions;
 		}
 		else if (divisions < 0) {
-			actualTimeWindow = baseTimeWindow / (-divisions);
+			windowDivision = -divisions;
 		}
 
-		// calculate the times at which triggers should fire, will be skewed by distribution
-		const float power = 1 + std::abs(distribution) * 2;
-		for (int i = 0; i <= numBursts; ++i) {
-			if (distribution >= 0) {
-				timings[i] = actualTimeWindow * std::pow((float)i / numBursts, power);
-			}
-			else {
-				timings[i] = actualTimeWindow * std::pow((float)i / numBursts, 1 / power);
-			}
+		// the times at which triggers should fire will be skewed by distribution
+		power = 1 + std::abs(distribution) * 2;
+		if (distribution < 0) {
+			power = 1 / power;
 		}
 
 		triggersOccurred = includeOriginalTrigger ? 0 : 1;
 		triggersRequested = inhibitBurst ? 1 : numBursts;
-		burstTimer.reset();
+		// the sample this is triggered on is sample 0 (process() is called next)
+		samplesSinceTrigger = -1;
+		scheduleNextEvent();
 	}
 };
 
@@ -171,13 +204,15 @@ struct Burst : Module {
 
 
 	dsp::SchmittTrigger pingTrigger; 	// for detecting Ping in
-	dsp::SchmittTrigger triggTrigger;	// for detecting Trigg in
+	dsp::SchmittTrigger triggTrigger[16];	// for detecting Trigg in (per channel)
 	dsp::BooleanTrigger buttonTrigger;	// for detecting when the trigger button is pressed
 	dsp::ClockDivider ledUpdate; 		// for only updating LEDs every N samples
 	const int ledUpdateRate = 16; 		// LEDs updated every N = 16 samples
 
 	PingableClock pingableClock;
-	BurstEngine burstEngine;
+	// one engine per channel of the trigger input, all running at the (shared) tempo of the ping clock
+	BurstEngine burstEngine[16];
+	int channels = 1;
 	bool includeOriginalTrigger = true;
 
 	Burst() {
@@ -200,68 +235,82 @@ struct Burst : Module {
 		configInput(TRIGGER_INPUT, "Trigger");
 		
 		ledUpdate.setDivision(ledUpdateRate);
+		onSampleRateChange();
+	}
+
+	void onSampleRateChange() override {
+		pingableClock.setSampleRate(APP->engine->getSampleRate());
 	}
 
 	void process(const ProcessArgs& args) override {
 
 		const bool pingReceived = pingTrigger.process(inputs[PING_INPUT].getVoltage());
-		pingableClock.process(pingReceived, args.sampleTime);
+		pingableClock.process(pingReceived);
 
 		if (ledUpdate.process()) {
 			updateLEDRing(args);
 		}
 
-		const float quantityCV = params[QUANTITY_CV_PARAM].getValue() * clamp(inputs[QUANTITY_INPUT].getVoltage(), -5.0, +10.f) / 5.f;
-		const int quantity = clamp((int)(params[QUANTITY_PARAM].getValue() + std::round(16 * quantityCV)), 1, MAX_REPETITIONS);
-
 		const bool loop = params[CYCLE_PARAM].getValue();
-
-		const float divMultCV = 4.0 * inputs[TIME_INPUT].getVoltage() / 10.f;
-		const int divMult = -clamp((int)(divMultCV + params[TIME_PARAM].getValue()), -4, +4);
-
-		const float distributionCV = inputs[DISTRIBUTION_INPUT].getVoltage() / 10.f;
-		const float distribution = clamp(distributionCV + params[DISTRIBUTION_PARAM].getValue(), -1.f, +1.f);
-
-		const bool triggerInputTriggered = triggTrigger.process(inputs[TRIGGER_INPUT].getVoltage());
 		const bool triggerButtonTriggered = buttonTrigger.process(params[TRIGGER_PARAM].getValue());
-		const bool startBurst = triggerInputTriggered || triggerButtonTriggered;
 
-		if (startBurst) {
-			const float prob = clamp(params[PROBABILITY_PARAM].getValue() + inputs[PROBABILITY_INPUT].getVoltage() / 10.f, 0.f, 1.f);
-			const bool inhibitBurst = rack::random::uniform() < prob;
+		channels = std::max(inputs[TRIGGER_INPUT].getChannels(), 1);
+		outputs[OUT_OUTPUT].setChannels(channels);
+		outputs[EOC_OUTPUT].setChannels(channels);
 
-			// remember to do at current tempo
-			burstEngine.trigger(quantity, divMult, pingableClock.tempo, distribution, inhibitBurst, includeOriginalTrigger);
-		}
+		bool anyBurstOut = false, anyEocOut = false;
+		for (int c = 0; c < channels; c++) {
+			const bool triggerInputTriggered = triggTrigger[c].process(inputs[TRIGGER_INPUT].getVoltage(c));
+			if (triggerInputTriggered || triggerButtonTriggered) {
+				startBurst(c, args.sampleTime);
+			}
 
-		float burstOut, eocOut;
-		bool eoc;
-		std::tie(burstOut, eocOut, eoc) = burstEngine.process(args.sampleTime);
+			float burstOut, eocOut;
+			bool eoc;
+			std::tie(burstOut, eocOut, eoc) = burstEngine[c].process();
 
-		// if the burst has finished, we can also re-trigger
-		if (eoc && loop) {
-			const float prob = clamp(params[PROBABILITY_PARAM].getValue() + inputs[PROBABILITY_INPUT].getVoltage() / 10.f, 0.f, 1.f);
-			const bool inhibitBurst = rack::random::uniform() < prob;
+			// if the burst has finished, we can also re-trigger
+			if (eoc && loop) {
+				startBurst(c, args.sampleTime);
+			}
 
-			// remember to do at current tempo
-			burstEngine.trigger(quantity, divMult, pingableClock.tempo, distribution, inhibitBurst, includeOriginalTrigger);
+			outputs[OUT_OUTPUT].setVoltage(10.f * burstOut, c);
+			outputs[EOC_OUTPUT].setVoltage(10.f * eocOut, c);
+			anyBurstOut |= burstOut > 0.f;
+			anyEocOut |= eocOut > 0.f;
 		}
 
 		const bool tempoOutHigh = pingableClock.isTempoOutHigh();
 		outputs[TEMPO_OUTPUT].setVoltage(10.f * tempoOutHigh);
 		lights[TEMPO_LIGHT].setBrightnessSmooth(tempoOutHigh, args.sampleTime);
 
-		outputs[OUT_OUTPUT].setVoltage(10.f * burstOut);
-		lights[OUT_LIGHT].setBrightnessSmooth(burstOut, args.sampleTime);
+		lights[OUT_LIGHT].setBrightnessSmooth(anyBurstOut, args.sampleTime);
+		lights[EOC_LIGHT].setBrightnessSmooth(anyEocOut, args.sampleTime);
+	}
+
+	// CVs are only read when a burst (re)starts, as that's the only time they are used
+	void startBurst(int c, float sampleTime) {
+		const float quantityCV = params[QUANTITY_CV_PARAM].getValue() * clamp(inputs[QUANTITY_INPUT].getPolyVoltage(c), -5.0, +10.f) / 5.f;
+		const int quantity = clamp((int)(params[QUANTITY_PARAM].getValue() + std::round(16 * quantityCV)), 1, MAX_REPETITIONS);
+
+		const float divMultCV = 4.0 * inputs[TIME_INPUT].getPolyVoltage(c) / 10.f;
+		const int divMult = -clamp((int)(divMultCV + params[TIME_PARAM].getValue()), -4, +4);
+
+		const float distributionCV = inputs[DISTRIBUTION_INPUT].getPolyVoltage(c) / 10.f;
+		const float distribution = clamp(distributionCV + params[DISTRIBUTION_PARAM].getValue(), -1.f, +1.f);
+
+		const float prob = clamp(params[PROBABILITY_PARAM].getValue() + inputs[PROBABILITY_INPUT].getPolyVoltage(c) / 10.f, 0.f, 1.f);
+		const bool inhibitBurst = rack::random::uniform() < prob;
 
-		outputs[EOC_OUTPUT].setVoltage(10.f * eocOut);
-		lights[EOC_LIGHT].setBrightnessSmooth(eocOut, args.sampleTime);
+		// remember to do at current tempo
+		burstEngine[c].trigger(quantity, divMult, pingableClock.getTempo(), distribution, inhibitBurst, includeOriginalTrigger, sampleTime);
 	}
 
 	void updateLEDRing(const ProcessArgs& args) {
 		int activeLed;
-		if (burstEngine.active) {
-			activeLed = (burstEngine.triggersOccurred - 1) % 16;
+		// the ring follows the first channel
+		if (burstEngine[0].active) {
+			activeLed = (burstEngine[0].triggersOccurred - 1) % 16;
 		}
 		else {
 			activeLed = (((int) params[QUANTITY_PARAM].getValue() - 1) % 16);
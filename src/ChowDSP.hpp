@@ -8,6 +8,7 @@ namespace chowdsp {
 	// * VariableOversampling.hpp
 	// * oversampling.hpp
 	// * iir.hpp
+	// DownsamplingBank is local, built from the AAFilter design above
 
 template <int ORDER, typename T = float>
 struct IIRFilter {
@@ -422,4 +423,93 @@ private:
 	BaseOversampling<T>* oss[NumOS] = { &os0, &os1, &os2, &os3, &os4 };
 };
 
+
+/**
+    Anti-aliasing / decimation stage for several signals oversampled at the same ratio (e.g. the outputs of an
+    oscillator), using the same 2*filtN-th order Butterworth design as AAFilter. All lanes share one set of
+    coefficients and are filtered together, lane by lane within each biquad, so the cost scales with the number
+    of lanes actually requested rather than with the number of filter objects.
+
+    Each lane keeps its own filter state, so callers can pass a different subset of lanes each block.
+    @code
+    bank.reset(sampleRate, ratio);
+    T* osBuffer = bank.getOSBuffer(lane);   // fill ratio samples for each lane in use
+    bank.downsample(lanes, numLanes, out);  // out[lane] for each lane in lanes
+    @endcode
+*/
+template<int filtN, int MAX_LANES, typename T = float>
+class DownsamplingBank {
+public:
+	static constexpr int MAX_RATIO = 16;
+
+	DownsamplingBank() = default;
+
+	/** Prepare the filters to process audio at a given (base) sample rate and oversampling ratio */
+	void reset(float sampleRate, int ratio) {
+		osRatio = clamp(ratio, 1, MAX_RATIO);
+
+		const float fc = 0.85f * (sampleRate / 2.0f);
+		auto Qs = AAFilter<filtN, float>::calculateButterQs(2 * filtN);
+		for (int i = 0; i < filtN; ++i) {
+			TBiquadFilter<float> biquad;
+			biquad.setParameters(TBiquadFilter<float>::Type::LOWPASS, fc / (osRatio * sampleRate), Qs[i], 1.0f);
+			for (int k = 0; k < 3; ++k) {
+				b[i][k] = biquad.b[k];
+				a[i][k] = biquad.a[k];
+			}
+		}
+
+		for (int lane = 0; lane < MAX_LANES; ++lane) {
+			std::fill(osBuffer[lane], &osBuffer[lane][MAX_RATIO], T(0.0f));
+			for (int i = 0; i < filtN; ++i) {
+				std::fill(z[lane][i], &z[lane][i][3], T(0.0f));
+			}
+		}
+	}
+
+	int getOversamplingRatio() const noexcept {
+		return osRatio;
+	}
+
+	/** Returns a pointer to the oversampled buffer of a lane */
+	inline T* getOSBuffer(int lane) noexcept {
+		return osBuffer[lane];
+	}
+
+	/** Filters and decimates the oversampled buffers of the given lanes, writing the result to out[lane] */
+	inline void downsample(const int* lanes, int numLanes, T* out) noexcept {
+		T x[MAX_LANES];
+		for (int k = 0; k < osRatio; ++k) {
+			for (int j = 0; j < numLanes; ++j) {
+				x[j] = osBuffer[lanes[j]][k];
+			}
+
+			for (int i = 0; i < filtN; ++i) {
+				const T b0 = b[i][0], b1 = b[i][1], b2 = b[i][2];
+				const T a1 = a[i][1], a2 = a[i][2];
+
+				// same as IIRFilter<3>::process(), for each lane
+				for (int j = 0; j < numLanes; ++j) {
+					T* zl = z[lanes[j]][i];
+					const T y = zl[1] + x[j] * b0;
+					zl[1] = zl[2] + x[j] * b1 - y * a1;
+					zl[2] = x[j] * b2 - y * a2;
+					x[j] = y;
+				}
+			}
+		}
+
+		for (int j = 0; j < numLanes; ++j) {
+			out[lanes[j]] = x[j];
+		}
+	}
+
+private:
+	int osRatio = 1;
+	float b[filtN][3] = {};
+	float a[filtN][3] = {};
+	T z[MAX_LANES][filtN][3] = {};
+	T osBuffer[MAX_LANES][MAX_RATIO] = {};
+};
+
 } // namespace chowdsp
@@ -24,6 +24,11 @@ struct DualAtenuverter : Module {
 		NUM_LIGHTS
 	};
 
+	// gains and offsets are read at control rate (and ramped in between), as are the lights
+	ControlRateDivider controlRate;
+	ControlRateRamp<float> att1, att2;
+	ControlRateRamp<float> offset1, offset2;
+
 	DualAtenuverter() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
 		configParam(ATEN1_PARAM, -1.0, 1.0, 0.0, "Ch 1 gain");
@@ -37,43 +42,45 @@ struct DualAtenuverter : Module {
 	void process(const ProcessArgs& args) override {
 		using simd::float_4;
 
-		float_4 out1[4] = {};
-		float_4 out2[4] = {};
-
 		int channels1 = inputs[IN1_INPUT].getChannels();
 		channels1 = channels1 > 0 ? channels1 : 1;
 		int channels2 = inputs[IN2_INPUT].getChannels();
 		channels2 = channels2 > 0 ? channels2 : 1;
 
-		float att1 = params[ATEN1_PARAM].getValue();
-		float att2 = params[ATEN2_PARAM].getValue();
-
-		float offset1 = params[OFFSET1_PARAM].getValue();
-		float offset2 = params[OFFSET2_PARAM].getValue();
-
-		for (int c = 0; c < channels1; c += 4) {
-			out1[c / 4] = clamp(inputs[IN1_INPUT].getVoltageSimd<float_4>(c) * att1 + offset1, -10.f, 10.f);
-		}
-		for (int c = 0; c < channels2; c += 4) {
-			out2[c / 4] = clamp(inputs[IN2_INPUT].getVoltageSimd<float_4>(c) * att2 + offset2, -10.f, 10.f);
+		const bool updateControls = controlRate.process();
+		if (updateControls) {
+			controlRate.setTarget(att1, params[ATEN1_PARAM].getValue());
+			controlRate.setTarget(att2, params[ATEN2_PARAM].getValue());
+			controlRate.setTarget(offset1, params[OFFSET1_PARAM].getValue());
+			controlRate.setTarget(offset2, params[OFFSET2_PARAM].getValue());
 		}
 
+		const float gain1 = att1.process();
+		const float gain2 = att2.process();
+		const float shift1 = offset1.process();
+		const float shift2 = offset2.process();
+
 		outputs[OUT1_OUTPUT].setChannels(channels1);
 		outputs[OUT2_OUTPUT].setChannels(channels2);
 
 		for (int c = 0; c < channels1; c += 4) {
-			outputs[OUT1_OUTPUT].setVoltageSimd(out1[c / 4], c);
+			outputs[OUT1_OUTPUT].setVoltageSimd(clamp(inputs[IN1_INPUT].getVoltageSimd<float_4>(c) * gain1 + shift1, -10.f, 10.f), c);
 		}
 		for (int c = 0; c < channels2; c += 4) {
-			outputs[OUT2_OUTPUT].setVoltageSimd(out2[c / 4], c);
+			outputs[OUT2_OUTPUT].setVoltageSimd(clamp(inputs[IN2_INPUT].getVoltageSimd<float_4>(c) * gain2 + shift2, -10.f, 10.f), c);
+		}
+
+		if (!updateControls) {
+			return;
 		}
 
+		const float lightTime = args.sampleTime * controlRate.getDivision();
 		float light1 = outputs[OUT1_OUTPUT].getVoltageSum() / channels1;
 		float light2 = outputs[OUT2_OUTPUT].getVoltageSum() / channels2;
 
 		if (channels1 == 1) {
-			lights[OUT1_LIGHT + 0].setSmoothBrightness(light1 / 5.f, args.sampleTime);
-			lights[OUT1_LIGHT + 1].setSmoothBrightness(-light1 / 5.f, args.sampleTime);
+			lights[OUT1_LIGHT + 0].setSmoothBrightness(light1 / 5.f, lightTime);
+			lights[OUT1_LIGHT + 1].setSmoothBrightness(-light1 / 5.f, lightTime);
 			lights[OUT1_LIGHT + 2].setBrightness(0.0f);
 		}
 		else {
@@ -83,8 +90,8 @@ struct DualAtenuverter : Module {
 		}
 
 		if (channels2 == 1) {
-			lights[OUT2_LIGHT + 0].setSmoothBrightness(light2 / 5.f, args.sampleTime);
-			lights[OUT2_LIGHT + 1].setSmoothBrightness(-light2 / 5.f, args.sampleTime);
+			lights[OUT2_LIGHT + 0].setSmoothBrightness(light2 / 5.f, lightTime);
+			lights[OUT2_LIGHT + 1].setSmoothBrightness(-light2 / 5.f, lightTime);
 			lights[OUT2_LIGHT + 2].setBrightness(0.0f);
 		}
 		else {
@@ -29,10 +29,28 @@ struct EvenVCO : Module {
 
 
 	float_4 phase[4] = {};
-	dsp::TSchmittTrigger<float_4> syncTrigger[4];
+	// V/Oct frequency (before FM) of the previous sample, where the per sub-sample ramp starts
+	float_4 lastBaseFreq[4] = {};
+	HardSync_4 hardSync[4];
 	bool removePulseDC = true;
 	bool limitPW = true;
 
+	enum AntialiasingMode {
+		// 3rd order DPW, run at the selected oversampling ratio
+		DPW_OVERSAMPLED,
+		// minBLEP corrected discontinuities, always at 1x
+		MINBLEP
+	};
+	AntialiasingMode antialiasingMode = DPW_OVERSAMPLED;
+
+	// step corrections: in minBLEP mode for every discontinuity (sine only has them under sync), in DPW mode only for
+	// hard sync (the DPW handles the waveforms' own edges), where they run at the oversampled rate; the triangle is
+	// always the DPW, and gets none
+	dsp::MinBlepGenerator<16, 32, float_4> sawMinBlep[4];
+	dsp::MinBlepGenerator<16, 32, float_4> squareMinBlep[4];
+	dsp::MinBlepGenerator<16, 32, float_4> evenMinBlep[4];
+	dsp::MinBlepGenerator<16, 32, float_4> sineMinBlep[4];
+
 	EvenVCO() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS);
 		configParam(OCTAVE_PARAM, -5.0, 4.0, 0.0, "Octave", "'", 0.5);
@@ -52,15 +70,13 @@ struct EvenVCO : Module {
 		configOutput(SAW_OUTPUT, "Sawtooth");
 		configOutput(SQUARE_OUTPUT, "Square");
 
+		onSampleRateChange();
 	}
 
 	void onSampleRateChange() override {
 		float sampleRate = APP->engine->getSampleRate();
-		for (int i = 0; i < NUM_OUTPUTS; ++i) {
-			for (int c = 0; c < 4; c++) {
-				oversampler[i][c].setOversamplingIndex(oversamplingIndex);
-				oversampler[i][c].reset(sampleRate);
-			}
+		for (int c = 0; c < 4; c++) {
+			downsampler[c].reset(sampleRate, 1 << oversamplingIndex);
 		}
 
 		for (int c = 0; c < 4; c++) {
@@ -70,7 +86,7 @@ struct EvenVCO : Module {
 			}
 		}
 
-		const float lowFreqRegime = oversampler[0][0].getOversamplingRatio() * 1e-3 * sampleRate;
+		const float lowFreqRegime = downsampler[0].getOversamplingRatio() * 1e-3 * sampleRate;
 		DEBUG("Low freq regime: %g", lowFreqRegime);
 	}
 
@@ -116,14 +132,166 @@ struct EvenVCO : Module {
 		return (sawOffsetBuff[0] - 2.0 * sawOffsetBuff[1] + sawOffsetBuff[2]);
 	}
 
+	// naive waveforms, as used by minBLEP mode
+	static float_4 naiveSaw(float_4 phase) {
+		return 2 * phase - 1.0;
+	}
+
+	static float_4 naiveSquare(float_4 phase, float_4 pw) {
+		return simd::ifelse(phase < pw, +1.0, -1.0);
+	}
+
+	static float_4 naiveDoubleSaw(float_4 phase) {
+		return 4.0 * simd::ifelse(phase < 0.5, phase, phase - 0.5) - 1.0;
+	}
+
+	static float_4 naiveSine(float_4 phase) {
+		return -simd::cos(M_PI + 2.0 * M_PI * phase);
+	}
+
+	/** Processes one voice group at 1x, with minBLEP correction of the step discontinuities in saw, square and even
+	(including those caused by hard sync). The triangle has no steps of its own, so it uses the 1x DPW. */
+	void processMinBlep(int c, int channels, float sampleTime, float_4 pitch, float_4 pw,
+	                    const int* activeOutputs, int numActiveOutputs) {
+		const int g = c / 4;
+		const int numLanes = std::min(4, channels - c);
+
+		const float_4 fmVoltage = inputs[FM_INPUT].getPolyVoltageSimd<float_4>(c) * 0.25f;
+		const float_4 freq = dsp::FREQ_C4 * exp2_taylor5_bipolar(pitch + fmVoltage);
+		const float_4 deltaPhase = simd::clamp(freq * sampleTime, 1e-6, 0.5f);
+
+		// only the connected waveforms (and the sine, if even needs it) are generated, along with their minBLEPs
+		const bool triActive = outputs[TRI_OUTPUT].isConnected();
+		const bool sawActive = outputs[SAW_OUTPUT].isConnected();
+		const bool squareActive = outputs[SQUARE_OUTPUT].isConnected();
+		const bool evenActive = outputs[EVEN_OUTPUT].isConnected();
+		const bool sineActive = outputs[SINE_OUTPUT].isConnected() || evenActive;
+
+		// hard sync: where in this sample the sync input crossed, as a position in (-1, 0] like the other edges
+		float_4 syncFraction;
+		const float_4 syncMask = hardSync[g].process(inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c), syncFraction);
+		const float_4 syncPosition = simd::ifelse(syncMask, syncFraction - 1.f, 0.f);
+		// synced lanes only run freely up to the sync point, so drop any of their edges after it
+		auto beforeSync = [&](float_4 mask, float_4 p) {
+			return mask & (p <= syncPosition);
+		};
+
+		// unwrapped phase, in [0, 1.5)
+		const float_4 oldPhase = phase[g];
+		const float_4 newPhase = oldPhase + deltaPhase;
+		const float_4 wrapped = newPhase >= 1.f;
+		phase[g] = newPhase - simd::ifelse(wrapped, 1.f, 0.f);
+
+		// for a crossing of x during this sample, its position relative to the current sample in (-1, 0]
+		auto crossingPosition = [&](float_4 x) {
+			return -(newPhase - x) / deltaPhase;
+		};
+
+		// wrap: saw and even fall, square rises
+		if (sawActive || squareActive || evenActive) {
+			const float_4 pWrap = crossingPosition(1.f);
+			const float_4 wrapMask = beforeSync(wrapped, pWrap);
+			if (sawActive) {
+				insertMinBlepDiscontinuities(sawMinBlep[g], wrapMask, pWrap, -2.f, numLanes);
+			}
+			if (squareActive) {
+				insertMinBlepDiscontinuities(squareMinBlep[g], wrapMask, pWrap, +2.f, numLanes);
+			}
+			if (evenActive) {
+				insertMinBlepDiscontinuities(evenMinBlep[g], wrapMask, pWrap, -2.f * 0.55f, numLanes);
+			}
+		}
+
+		// pulse width crossing (either before or after the wrap): square falls
+		if (squareActive) {
+			const float_4 pPw = crossingPosition(pw);
+			const float_4 pPwAfterWrap = crossingPosition(pw + 1.f);
+			const float_4 pwCrossed = beforeSync((oldPhase < pw) & (newPhase >= pw), pPw);
+			const float_4 pwCrossedAfterWrap = beforeSync(newPhase >= pw + 1.f, pPwAfterWrap);
+			insertMinBlepDiscontinuities(squareMinBlep[g], pwCrossed, pPw, -2.f, numLanes);
+			insertMinBlepDiscontinuities(squareMinBlep[g], pwCrossedAfterWrap, pPwAfterWrap, -2.f, numLanes);
+		}
+
+		// half way: the double frequency saw in even falls
+		if (evenActive) {
+			const float_4 pHalf = crossingPosition(0.5f);
+			const float_4 pHalfAfterWrap = crossingPosition(1.5f);
+			const float_4 halfCrossed = beforeSync((oldPhase < 0.5f) & (newPhase >= 0.5f), pHalf);
+			const float_4 halfCrossedAfterWrap = beforeSync(newPhase >= 1.5f, pHalfAfterWrap);
+			insertMinBlepDiscontinuities(evenMinBlep[g], halfCrossed, pHalf, -2.f * 0.55f, numLanes);
+			insertMinBlepDiscontinuities(evenMinBlep[g], halfCrossedAfterWrap, pHalfAfterWrap, -2.f * 0.55f, numLanes);
+		}
+
+		// hard sync resets to 0.5 at the crossing, so every waveform jumps from its value there to its value at 0.5,
+		// then the phase runs on for the rest of the sample
+		if (simd::movemask(syncMask)) {
+			const float_4 syncPhase = 0.5f;
+			float_4 phaseAtSync = oldPhase + syncFraction * deltaPhase;
+			phaseAtSync -= simd::ifelse(phaseAtSync >= 1.f, 1.f, 0.f);
+			if (sawActive) {
+				insertMinBlepDiscontinuities(sawMinBlep[g], syncMask, syncPosition, naiveSaw(syncPhase) - naiveSaw(phaseAtSync), numLanes);
+			}
+			if (evenActive) {
+				insertMinBlepDiscontinuities(evenMinBlep[g], syncMask, syncPosition,
+				                             0.55f * (naiveDoubleSaw(syncPhase) - naiveDoubleSaw(phaseAtSync)), numLanes);
+			}
+			if (sineActive) {
+				insertMinBlepDiscontinuities(sineMinBlep[g], syncMask, syncPosition, naiveSine(syncPhase) - naiveSine(phaseAtSync), numLanes);
+			}
+
+			// less than half a cycle remains (deltaPhase <= 0.5), so of the edges only the pulse width can follow
+			const float_4 postSyncPhase = syncPhase + (1.f - syncFraction) * deltaPhase;
+			if (squareActive) {
+				insertMinBlepDiscontinuities(squareMinBlep[g], syncMask, syncPosition,
+				                             naiveSquare(syncPhase, pw) - naiveSquare(phaseAtSync, pw), numLanes);
+				const float_4 pwCrossedAfterSync = syncMask & (pw > syncPhase) & (postSyncPhase >= pw);
+				insertMinBlepDiscontinuities(squareMinBlep[g], pwCrossedAfterSync, -(postSyncPhase - pw) / deltaPhase, -2.f, numLanes);
+			}
+			phase[g] = simd::ifelse(syncMask, postSyncPhase, phase[g]);
+		}
+
+		float_4 out[NUM_OUTPUTS];
+		if (sineActive) {
+			out[SINE_OUTPUT] = naiveSine(phase[g]) + sineMinBlep[g].process();
+		}
+		if (sawActive) {
+			out[SAW_OUTPUT] = naiveSaw(phase[g]) + sawMinBlep[g].process();
+		}
+		if (squareActive) {
+			out[SQUARE_OUTPUT] = naiveSquare(phase[g], pw) + (removePulseDC ? 2.f * (0.5f - pw) : 0.f) + squareMinBlep[g].process();
+		}
+		if (evenActive) {
+			out[EVEN_OUTPUT] = 0.55 * (naiveDoubleSaw(phase[g]) + 1.27 * out[SINE_OUTPUT]) + evenMinBlep[g].process();
+		}
+
+		// triangle: 3rd order DPW at 1x, falling back to naive at low frequencies as in DPW mode; the phase history is
+		// extrapolated back from the current phase (as in DPW mode), as the actual one jumps under sync
+		if (triActive) {
+			float_4 phases[3];
+			phases[0] = phase[g] - 2 * deltaPhase + simd::ifelse(phase[g] < 2 * deltaPhase, 1.f, 0.f);
+			phases[1] = phase[g] - deltaPhase + simd::ifelse(phase[g] < deltaPhase, 1.f, 0.f);
+			phases[2] = phase[g];
+			const float_4 lowFreqRegime = simd::abs(deltaPhase) < 1e-3;
+			const float_4 denominatorInv = 0.25 / (deltaPhase * deltaPhase);
+			const float_4 dpwOrder1 = 1.0 - 2.0 * simd::abs(2 * phase[g] - 1.0);
+			const float_4 dpwOrder3 = aliasSuppressedTri(phases) * denominatorInv;
+			out[TRI_OUTPUT] = -simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
+		}
+
+		for (int j = 0; j < numActiveOutputs; ++j) {
+			outputs[activeOutputs[j]].setVoltageSimd(5.f * out[activeOutputs[j]], c);
+		}
+	}
+
 	enum UpsampledInputs {
 		FM_INPUT_UP,
-		SYNC_INPUT_UP,
 		NUM_UPSAMPLED_INPUTS
 	};
 	chowdsp::VariableOversampling<6, float_4> oversamplerInputs[NUM_UPSAMPLED_INPUTS][4]; 	// uses a 2*6=12th order Butterworth filter
-	chowdsp::VariableOversampling<6, float_4> oversampler[NUM_OUTPUTS][4]; 	// uses a 2*6=12th order Butterworth filter
+	// one anti-aliasing filter bank per voice group, with a lane for each output
+	chowdsp::DownsamplingBank<6, NUM_OUTPUTS, float_4> downsampler[4]; 	// uses a 2*6=12th order Butterworth filter
 	int oversamplingIndex = 2; 	// default is 2^oversamplingIndex == x4 oversampling
+	static constexpr int MAX_OVERSAMPLING_RATIO = chowdsp::DownsamplingBank<6, NUM_OUTPUTS, float_4>::MAX_RATIO;
 
 	void process(const ProcessArgs& args) override {
 
@@ -131,7 +299,22 @@ struct EvenVCO : Module {
 		const int channels = std::max({1, inputs[PITCH1_INPUT].getChannels(), inputs[PITCH2_INPUT].getChannels()});
 
 		const float pitchKnobs = 1.f + std::round(params[OCTAVE_PARAM].getValue()) + params[TUNE_PARAM].getValue() / 12.f;
-		const int oversamplingRatio = oversampler[0][0].getOversamplingRatio();
+		const int oversamplingRatio = downsampler[0].getOversamplingRatio();
+
+		// decide once per block which outputs (lanes of the downsampler) are generated
+		int activeOutputs[NUM_OUTPUTS];
+		int numActiveOutputs = 0;
+		for (int i = 0; i < NUM_OUTPUTS; ++i) {
+			if (outputs[i].isConnected()) {
+				activeOutputs[numActiveOutputs++] = i;
+			}
+		}
+		// nothing to generate (EvenVCO has no gain stage, so this is the only case where a voice is provably silent)
+		if (numActiveOutputs == 0) {
+			return;
+		}
+		// even is built from the sine, so needs it even if sine itself isn't patched
+		const bool needSine = outputs[SINE_OUTPUT].isConnected() || outputs[EVEN_OUTPUT].isConnected();
 
 		for (int c = 0; c < channels; c += 4) {
 			float_4 pw = simd::clamp(params[PWM_PARAM].getValue() + inputs[PWM_INPUT].getPolyVoltageSimd<float_4>(c) / 5.f, -1.f, 1.f);
@@ -148,121 +331,160 @@ struct EvenVCO : Module {
 			// for it to be added back in for hardware compatibility reasons
 			const float_4 pulseDCOffset = (!removePulseDC) * 2.f * (0.5f - pw);
 
-			// input oversampling buffers
-			float_4* osBufferSync = oversamplerInputs[SYNC_INPUT_UP][c / 4].getOSBuffer();
+			if (antialiasingMode == MINBLEP) {
+				processMinBlep(c, channels, args.sampleTime, pitchKnobs + pitch, pw, activeOutputs, numActiveOutputs);
+				continue;
+			}
+
 			float_4* osBufferFM = oversamplerInputs[FM_INPUT_UP][c / 4].getOSBuffer();
 
-			// upsample hard sync input (if connected)
-			if (inputs[SYNC_INPUT].isConnected()) {
-				oversamplerInputs[SYNC_INPUT_UP][c].upsample(inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c));
-			}
-			else {
-				std::fill(osBufferSync, &osBufferSync[oversamplingRatio], float_4::zero());
-			}
+			// hard sync is detected on the raw input at 1x: the crossing time picks the sub-sample where the reset lands,
+			// and what is left of that sub-sample after the crossing is the phase it starts again with
+			float_4 syncFraction;
+			const float_4 syncMask = hardSync[c / 4].process(inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c), syncFraction);
+			const float_4 syncTime = syncFraction * oversamplingRatio;
+			const float_4 syncSubSample = simd::ifelse(syncMask, simd::ceil(syncTime) - 1.f, -1.f);
+			// the reset's position within its sub-sample, in (-1, 0], and the phase it interrupts (for the step sizes)
+			const float_4 syncPosition = syncTime - (syncSubSample + 1.f);
+			float_4 phaseAtSync = 0.f;
+			const bool anySync = simd::movemask(syncMask);
+			const int numLanes = std::min(4, channels - c);
+
 			// upsample FM input (if connected)
-			if (inputs[FM_INPUT].isConnected()) {
-				oversamplerInputs[FM_INPUT_UP][c].upsample(inputs[FM_INPUT].getPolyVoltageSimd<float_4>(c));
-			}
-			else {
-				std::fill(osBufferFM, &osBufferFM[oversamplingRatio], float_4::zero());
+			const bool fmConnected = inputs[FM_INPUT].isConnected();
+			if (fmConnected) {
+				oversamplerInputs[FM_INPUT_UP][c / 4].upsample(inputs[FM_INPUT].getPolyVoltageSimd<float_4>(c));
 			}
 
-			float_4* osBufferTri = oversampler[TRI_OUTPUT][c / 4].getOSBuffer();
-			float_4* osBufferSaw = oversampler[SAW_OUTPUT][c / 4].getOSBuffer();
-			float_4* osBufferSin = oversampler[SINE_OUTPUT][c / 4].getOSBuffer();
-			float_4* osBufferSquare = oversampler[SQUARE_OUTPUT][c / 4].getOSBuffer();
-			float_4* osBufferEven = oversampler[EVEN_OUTPUT][c / 4].getOSBuffer();
+			// the V/Oct part of the pitch only changes once per sample, so evaluate the exponential once and ramp it
+			// linearly across the sub-samples; only FM (which is upsampled) needs the exponential per sub-sample
+			const float_4 baseFreq = dsp::FREQ_C4 * exp2_taylor5_bipolar(pitchKnobs + pitch);
+			const float_4 startFreq = simd::ifelse(lastBaseFreq[c / 4] == 0.f, baseFreq, lastBaseFreq[c / 4]);
+			const float_4 freqStep = (baseFreq - startFreq) / oversamplingRatio;
+			lastBaseFreq[c / 4] = baseFreq;
+
+			// phase trajectory for this block, shared by all waveforms
+			float_4 phases[MAX_OVERSAMPLING_RATIO][3]; 	// phase as extrapolated to the current and two previous samples
+			float_4 denominatorInv[MAX_OVERSAMPLING_RATIO];
+			float_4 lowFreqRegime[MAX_OVERSAMPLING_RATIO];
 			for (int i = 0; i < oversamplingRatio; ++i) {
-				// use upsampled FM input
-				const float_4 fmVoltage = osBufferFM[i] * 0.25f;
-				const float_4 freq = dsp::FREQ_C4 * simd::pow(2.f, pitchKnobs + pitch + fmVoltage);
+				float_4 freq = startFreq + freqStep * (i + 1);
+				if (fmConnected) {
+					// use upsampled FM input
+					freq *= exp2_taylor5_bipolar(osBufferFM[i] * 0.25f);
+				}
 				const float_4 deltaBasePhase = simd::clamp(freq * args.sampleTime / oversamplingRatio, 1e-6, 0.5f);
 				// floating point arithmetic doesn't work well at low frequencies, specifically because the finite difference denominator
 				// becomes tiny - we check for that scenario and use naive / 1st order waveforms in that frequency regime (as aliasing isn't
 				// a problem there). With no oversampling, at 44100Hz, the threshold frequency is 44.1Hz.
-				const float_4 lowFreqRegime = simd::abs(deltaBasePhase) < 1e-3;
+				lowFreqRegime[i] = simd::abs(deltaBasePhase) < 1e-3;
 				// 1 / denominator for the second-order FD
-				const float_4 denominatorInv = 0.25 / (deltaBasePhase * deltaBasePhase);
+				denominatorInv[i] = 0.25 / (deltaBasePhase * deltaBasePhase);
 
 				phase[c / 4] += deltaBasePhase;
 				// ensure within [0, 1]
 				phase[c / 4] -= simd::floor(phase[c / 4]);
 
-				const float_4 syncMask = syncTrigger[c / 4].process(osBufferSync[i]);
-				phase[c / 4] = simd::ifelse(syncMask, 0.5f, phase[c / 4]);
+				if (anySync) {
+					const float_4 syncNow = syncSubSample == float_4(i);
+					const float_4 syncResidual = (i + 1.f - syncTime) * deltaBasePhase;
+					const float_4 interrupted = phase[c / 4] - syncResidual;
+					phaseAtSync = simd::ifelse(syncNow, interrupted - simd::floor(interrupted), phaseAtSync);
+					phase[c / 4] = simd::ifelse(syncNow, 0.5f + syncResidual, phase[c / 4]);
+				}
+
+				phases[i][0] = phase[c / 4] - 2 * deltaBasePhase + simd::ifelse(phase[c / 4] < 2 * deltaBasePhase, 1.f, 0.f);
+				phases[i][1] = phase[c / 4] - deltaBasePhase + simd::ifelse(phase[c / 4] < deltaBasePhase, 1.f, 0.f);
+				phases[i][2] = phase[c / 4];
+			}
 
-				float_4 phases[3]; // phase as extrapolated to the current and two previous samples
+			chowdsp::DownsamplingBank<6, NUM_OUTPUTS, float_4>& bank = downsampler[c / 4];
 
-				phases[0] = phase[c / 4] - 2 * deltaBasePhase + simd::ifelse(phase[c / 4] < 2 * deltaBasePhase, 1.f, 0.f);
-				phases[1] = phase[c / 4] - deltaBasePhase + simd::ifelse(phase[c / 4] < deltaBasePhase, 1.f, 0.f);
-				phases[2] = phase[c / 4];
+			// the DPW doesn't see the sync reset as an edge, so its step (from the interrupted phase to 0.5) is corrected
+			// with a minBLEP at the oversampled rate
+			float_4 syncJump[NUM_OUTPUTS] = {};
+			if (anySync) {
+				syncJump[SINE_OUTPUT] = naiveSine(0.5f) - naiveSine(phaseAtSync);
+				syncJump[SAW_OUTPUT] = naiveSaw(0.5f) - naiveSaw(phaseAtSync);
+				syncJump[SQUARE_OUTPUT] = naiveSquare(0.5f, pw) - naiveSquare(phaseAtSync, pw);
+				syncJump[EVEN_OUTPUT] = 0.55f * (naiveDoubleSaw(0.5f) - naiveDoubleSaw(phaseAtSync));
+			}
+			auto syncStep = [&](dsp::MinBlepGenerator<16, 32, float_4>& minBlep, int i, int output) {
+				if (anySync) {
+					insertMinBlepDiscontinuities(minBlep, syncSubSample == float_4(i), syncPosition, syncJump[output], numLanes);
+				}
+				return minBlep.process();
+			};
 
-				if (outputs[SINE_OUTPUT].isConnected() || outputs[EVEN_OUTPUT].isConnected()) {
+			// only generate the waveforms that are needed
+			float_4* osBufferSin = bank.getOSBuffer(SINE_OUTPUT);
+			if (needSine) {
+				for (int i = 0; i < oversamplingRatio; ++i) {
 					// sin doesn't need PDW
-					osBufferSin[i] = -simd::cos(M_PI + 2.0 * M_PI * phase[c / 4]);
+					osBufferSin[i] = naiveSine(phases[i][2]) + syncStep(sineMinBlep[c / 4], i, SINE_OUTPUT);
 				}
+			}
 
-				if (outputs[TRI_OUTPUT].isConnected()) {
-					const float_4 dpwOrder1 = 1.0 - 2.0 * simd::abs(2 * phase[c / 4] - 1.0);
-					const float_4 dpwOrder3 = aliasSuppressedTri(phases) * denominatorInv;
+			if (outputs[TRI_OUTPUT].isConnected()) {
+				float_4* osBufferTri = bank.getOSBuffer(TRI_OUTPUT);
+				for (int i = 0; i < oversamplingRatio; ++i) {
+					const float_4 dpwOrder1 = 1.0 - 2.0 * simd::abs(2 * phases[i][2] - 1.0);
+					const float_4 dpwOrder3 = aliasSuppressedTri(phases[i]) * denominatorInv[i];
 
-					osBufferTri[i] = -simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
+					osBufferTri[i] = -simd::ifelse(lowFreqRegime[i], dpwOrder1, dpwOrder3);
 				}
+			}
 
-				if (outputs[SAW_OUTPUT].isConnected()) {
-					const float_4 dpwOrder1 = 2 * phase[c / 4] - 1.0;
-					const float_4 dpwOrder3 = aliasSuppressedSaw(phases) * denominatorInv;
+			if (outputs[SAW_OUTPUT].isConnected()) {
+				float_4* osBufferSaw = bank.getOSBuffer(SAW_OUTPUT);
+				for (int i = 0; i < oversamplingRatio; ++i) {
+					const float_4 dpwOrder1 = 2 * phases[i][2] - 1.0;
+					const float_4 dpwOrder3 = aliasSuppressedSaw(phases[i]) * denominatorInv[i];
 
-					osBufferSaw[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
+					osBufferSaw[i] = simd::ifelse(lowFreqRegime[i], dpwOrder1, dpwOrder3)
+					                 + syncStep(sawMinBlep[c / 4], i, SAW_OUTPUT);
 				}
+			}
 
-				if (outputs[SQUARE_OUTPUT].isConnected()) {
-
-					float_4 dpwOrder1 = simd::ifelse(phase[c / 4] < pw, +1.0, -1.0);
+			if (outputs[SQUARE_OUTPUT].isConnected()) {
+				float_4* osBufferSquare = bank.getOSBuffer(SQUARE_OUTPUT);
+				for (int i = 0; i < oversamplingRatio; ++i) {
+					float_4 dpwOrder1 = simd::ifelse(phases[i][2] < pw, +1.0, -1.0);
 					dpwOrder1 += removePulseDC ? 2.f * (0.5f - pw) : 0.f;
 
-					float_4 saw = aliasSuppressedSaw(phases);
-					float_4 sawOffset = aliasSuppressedOffsetSaw(phases, pw);
-					float_4 dpwOrder3 = (saw - sawOffset) * denominatorInv - pulseDCOffset;
-
-					osBufferSquare[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-				}
-
-				if (outputs[EVEN_OUTPUT].isConnected()) {
+					float_4 saw = aliasSuppressedSaw(phases[i]);
+					float_4 sawOffset = aliasSuppressedOffsetSaw(phases[i], pw);
+					float_4 dpwOrder3 = (saw - sawOffset) * denominatorInv[i] - pulseDCOffset;
 
-					float_4 dpwOrder1 = 4.0 * simd::ifelse(phase[c / 4] < 0.5, phase[c / 4], phase[c / 4] - 0.5) - 1.0;
-					float_4 dpwOrder3 = aliasSuppressedDoubleSaw(phases) * denominatorInv;
-					float_4 doubleSaw = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-					osBufferEven[i] = 0.55 * (doubleSaw + 1.27 * osBufferSin[i]);
+					osBufferSquare[i] = simd::ifelse(lowFreqRegime[i], dpwOrder1, dpwOrder3)
+					                    + syncStep(squareMinBlep[c / 4], i, SQUARE_OUTPUT);
 				}
-
-
-			} 	// end of oversampling loop
-
-			// downsample (if required)
-			if (outputs[SINE_OUTPUT].isConnected()) {
-				const float_4 outSin = (oversamplingRatio > 1) ? oversampler[SINE_OUTPUT][c / 4].downsample() : osBufferSin[0];
-				outputs[SINE_OUTPUT].setVoltageSimd(5.f * outSin, c);
 			}
 
-			if (outputs[TRI_OUTPUT].isConnected()) {
-				const float_4 outTri = (oversamplingRatio > 1) ? oversampler[TRI_OUTPUT][c / 4].downsample() : osBufferTri[0];
-				outputs[TRI_OUTPUT].setVoltageSimd(5.f * outTri, c);
+			if (outputs[EVEN_OUTPUT].isConnected()) {
+				float_4* osBufferEven = bank.getOSBuffer(EVEN_OUTPUT);
+				for (int i = 0; i < oversamplingRatio; ++i) {
+					float_4 dpwOrder1 = 4.0 * simd::ifelse(phases[i][2] < 0.5, phases[i][2], phases[i][2] - 0.5) - 1.0;
+					float_4 dpwOrder3 = aliasSuppressedDoubleSaw(phases[i]) * denominatorInv[i];
+					float_4 doubleSaw = simd::ifelse(lowFreqRegime[i], dpwOrder1, dpwOrder3);
+					osBufferEven[i] = 0.55 * (doubleSaw + 1.27 * osBufferSin[i])
+					                  + syncStep(evenMinBlep[c / 4], i, EVEN_OUTPUT);
+				}
 			}
 
-			if (outputs[SAW_OUTPUT].isConnected()) {
-				const float_4 outSaw = (oversamplingRatio > 1) ? oversampler[SAW_OUTPUT][c / 4].downsample() : osBufferSaw[0];
-				outputs[SAW_OUTPUT].setVoltageSimd(5.f * outSaw, c);
+			// downsample (if required) all connected outputs together
+			float_4 out[NUM_OUTPUTS];
+			if (oversamplingRatio > 1) {
+				bank.downsample(activeOutputs, numActiveOutputs, out);
 			}
-
-			if (outputs[SQUARE_OUTPUT].isConnected()) {
-				const float_4 outSquare = (oversamplingRatio > 1) ? oversampler[SQUARE_OUTPUT][c / 4].downsample() : osBufferSquare[0];
-				outputs[SQUARE_OUTPUT].setVoltageSimd(5.f * outSquare, c);
+			else {
+				for (int j = 0; j < numActiveOutputs; ++j) {
+					out[activeOutputs[j]] = bank.getOSBuffer(activeOutputs[j])[0];
+				}
 			}
 
-			if (outputs[EVEN_OUTPUT].isConnected()) {
-				const float_4 outEven = (oversamplingRatio > 1) ? oversampler[EVEN_OUTPUT][c / 4].downsample() : osBufferEven[0];
-				outputs[EVEN_OUTPUT].setVoltageSimd(5.f * outEven, c);
+			for (int j = 0; j < numActiveOutputs; ++j) {
+				outputs[activeOutputs[j]].setVoltageSimd(5.f * out[activeOutputs[j]], c);
 			}
 
 		} 	// end of channels loop
@@ -280,7 +502,8 @@ struct EvenVCO : Module {
 		json_t* rootJ = json_object();
 		json_object_set_new(rootJ, "removePulseDC", json_boolean(removePulseDC));
 		json_object_set_new(rootJ, "limitPW", json_boolean(limitPW));
-		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversampler[0][0].getOversamplingIndex()));
+		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversamplingIndex));
+		json_object_set_new(rootJ, "antialiasingMode", json_integer(antialiasingMode));
 		return rootJ;
 	}
 
@@ -300,6 +523,11 @@ struct EvenVCO : Module {
 			oversamplingIndex = json_integer_value(oversamplingIndexJ);
 			onSampleRateChange();
 		}
+
+		json_t* antialiasingModeJ = json_object_get(rootJ, "antialiasingMode");
+		if (antialiasingModeJ) {
+			antialiasingMode = (AntialiasingMode) json_integer_value(antialiasingModeJ);
+		}
 	}
 };
 
@@ -344,6 +572,8 @@ struct EvenVCOWidget : ModuleWidget {
 		}
 		                                ));
 
+		menu->addChild(createIndexPtrSubmenuItem("Anti-aliasing", {"DPW (oversampled)", "minBLEP (no oversampling)"}, &module->antialiasingMode));
+
 		menu->addChild(createIndexSubmenuItem("Oversampling",
 		{"Off", "x2", "x4", "x8"},
 		[ = ]() {
@@ -352,7 +582,8 @@ struct EvenVCOWidget : ModuleWidget {
 		[ = ](int mode) {
 			module->oversamplingIndex = mode;
 			module->onSampleRateChange();
-		}
+		},
+		module->antialiasingMode == EvenVCO::MINBLEP
 		                                     ));
 	}
 };
@@ -34,8 +34,9 @@ struct HexmixVCA : Module {
 	};
 
 	const static int numRows = 6;
-	dsp::ClockDivider cvDivider;
-	float outputLevels[numRows] = {};
+	// levels and shapes are updated at control rate, levels are also ramped in between so that they don't step
+	ControlRateDivider cvDivider;
+	ControlRateRamp<float> outputLevels[numRows];
 	float shapes[numRows] = {};
 	bool finalRowIsMix = true;
 
@@ -53,11 +54,6 @@ struct HexmixVCA : Module {
 
 			configBypass(IN_INPUT + i, OUT_OUTPUT + i);
 		}
-		cvDivider.setDivision(16);
-
-		for (int row = 0; row < numRows; ++row) {
-			outputLevels[row] = 1.f;
-		}
 	}
 
 	void process(const ProcessArgs& args) override {
@@ -68,11 +64,12 @@ struct HexmixVCA : Module {
 		if (cvDivider.process()) {
 			for (int row = 0; row < numRows; ++row) {
 				shapes[row] = params[SHAPE_PARAM + row].getValue();
-				outputLevels[row] = params[VOL_PARAM + row].getValue();
+				cvDivider.setTarget(outputLevels[row], params[VOL_PARAM + row].getValue());
 			}
 		}
 
 		for (int row = 0; row < numRows; ++row) {
+			const float outputLevel = outputLevels[row].process();
 			bool finalRow = (row == numRows - 1);
 			int channels = 1;
 			float_4 in[4] = {};
@@ -87,7 +84,7 @@ struct HexmixVCA : Module {
 				}
 
 				float cvGain = clamp(inputs[CV_INPUT + row].getNormalVoltage(10.f) / 10.f, 0.f, 1.f);
-				float gain = gainFunction(cvGain, shapes[row]) * outputLevels[row];
+				float gain = gainFunction(cvGain, shapes[row]) * outputLevel;
 
 				for (int c = 0; c < channels; c += 4) {
 					in[c / 4] = inputs[row].getVoltageSimd<float_4>(c) * gain;
@@ -1,6 +1,7 @@
 #include "plugin.hpp"
 #include "ChowDSP.hpp"
 
+using simd::float_4;
 
 struct Kickall : Module {
 	enum ParamIds {
@@ -36,15 +37,19 @@ struct Kickall : Module {
 	static constexpr float minPitchDecay = 0.0075f;
 	static constexpr float maxPitchDecay = 1.f;
 	static constexpr float bendRange = 10000;
-	float phase = 0.f;
-	ADEnvelope volume;
-	ADEnvelope pitch;
+	float_4 phase[4] = {};
+	ADEnvelope_4 volume[4];
+	ADEnvelope_4 pitch[4];
 
-	dsp::SchmittTrigger gateTrigger;
+	// mappings of the bend and decay sliders, only recomputed when they move
+	float bendParam = NAN, bend = 0.f;
+	float decayParam = NAN, volumeDecay = minVolumeDecay;
+
+	SubSampleTrigger_4 gateTrigger[4];
 	dsp::BooleanTrigger buttonTrigger;
 
 	static const int UPSAMPLE = 8;
-	chowdsp::Oversampling<UPSAMPLE> oversampler;
+	chowdsp::Oversampling<UPSAMPLE, 4, float_4> oversampler[4];
 
 	Kickall() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS, NUM_LIGHTS);
@@ -56,11 +61,15 @@ struct Kickall : Module {
 		configParam(TIME_PARAM, 0.f, 1.0f, 0.f, "Pitch envelope decay time");
 		configParam(BEND_PARAM, 0.f, 1.f, 0.f, "Pitch envelope attenuator");
 
-		volume.attackTime = 0.01;
-		volume.attackShape = 0.5;
-		volume.decayShape = 3.0;
-		pitch.attackTime = 0.00165;
-		pitch.decayShape = 3.0;
+		for (int c = 0; c < 4; c++) {
+			volume[c].attackTime = 0.01;
+			volume[c].attackShape = 0.5;
+			volume[c].decayShape = 3.0;
+			pitch[c].attackTime = 0.00165;
+			pitch[c].decayShape = 3.0;
+			// i.e. 0.1V / 2V after halving the input
+			gateTrigger[c] = SubSampleTrigger_4(0.2f, 4.f);
+		}
 
 		configInput(TRIGG_INPUT, "Trigger");
 		configInput(VOLUME_INPUT, "Gain");
@@ -76,54 +85,80 @@ struct Kickall : Module {
 	}
 
 	void onSampleRateChange() override {
-		oversampler.reset(APP->engine->getSampleRate());
+		for (int c = 0; c < 4; c++) {
+			oversampler[c].reset(APP->engine->getSampleRate());
+		}
 	}
 
 	void process(const ProcessArgs& args) override {
-		// TODO: check values
-		const bool risingEdgeGate = gateTrigger.process(inputs[TRIGG_INPUT].getVoltage() / 2.0f, 0.1, 2.0);
+		// polyphony is defined by the largest number of active channels on trigger and CV inputs
+		const int channels = std::max({1, inputs[TRIGG_INPUT].getChannels(), inputs[VOLUME_INPUT].getChannels(),
+		                               inputs[TUNE_INPUT].getChannels(), inputs[SHAPE_INPUT].getChannels(),
+		                               inputs[DECAY_INPUT].getChannels()});
+
+		// the button triggers all voices
 		const bool buttonTriggered = buttonTrigger.process(params[TRIGG_BUTTON_PARAM].getValue());
-		// can be triggered by either rising edge on trigger in, or a button press
-		if (risingEdgeGate || buttonTriggered) {
-			volume.trigger();
-			pitch.trigger();
+
+		// shared by all voices
+		if (params[BEND_PARAM].getValue() != bendParam) {
+			bendParam = params[BEND_PARAM].getValue();
+			bend = bendRange * bendParam * bendParam * bendParam;
 		}
+		if (params[DECAY_PARAM].getValue() != decayParam) {
+			decayParam = params[DECAY_PARAM].getValue();
+			volumeDecay = minVolumeDecay * std::pow(2.f, decayParam * std::log2(maxVolumeDecay / minVolumeDecay));
+		}
+		const float pitchDecay = rescale(params[TIME_PARAM].getValue(), 0.f, 1.0f, minPitchDecay, maxPitchDecay);
 
-		const float vcaGain = clamp(inputs[VOLUME_INPUT].getNormalVoltage(10.f) / 10.f, 0.f, 1.0f);
+		float_4 maxEnv = 0.f;
+		for (int c = 0; c < channels; c += 4) {
+			// TODO: check values
+			float_4 crossing;
+			const float_4 risingEdgeGate = gateTrigger[c / 4].process(inputs[TRIGG_INPUT].getPolyVoltageSimd<float_4>(c), crossing);
+			// can be triggered by either rising edge on trigger in, or a button press
+			const float_4 triggered = buttonTriggered ? float_4::mask() : risingEdgeGate;
+			// envelopes start from where the trigger crossed the threshold, between samples
+			const float_4 elapsed = buttonTriggered ? 0.f : SubSampleTrigger_4::getTimeSinceCrossing(crossing, args.sampleTime);
+			volume[c / 4].trigger(triggered, elapsed);
+			pitch[c / 4].trigger(triggered, elapsed);
 
-		// pitch envelope
-		const float bend = bendRange * std::pow(params[BEND_PARAM].getValue(), 3.0);
-		pitch.decayTime = rescale(params[TIME_PARAM].getValue(), 0.f, 1.0f, minPitchDecay, maxPitchDecay);
-		pitch.process(args.sampleTime);
+			const float_4 vcaGain = simd::clamp(inputs[VOLUME_INPUT].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.0f);
 
-		// volume envelope
-		const float volumeDecay = minVolumeDecay * std::pow(2.f, params[DECAY_PARAM].getValue() * std::log2(maxVolumeDecay / minVolumeDecay));
-		volume.decayTime = clamp(volumeDecay + inputs[DECAY_INPUT].getVoltage() * 0.1f, 0.01, 10.0);
-		volume.process(args.sampleTime);
+			// pitch envelope
+			pitch[c / 4].decayTime = pitchDecay;
+			pitch[c / 4].process(args.sampleTime);
 
-		float freq = params[TUNE_PARAM].getValue();
-		freq *= std::pow(2.f, inputs[TUNE_INPUT].getVoltage());
+			// volume envelope
+			volume[c / 4].decayTime = simd::clamp(volumeDecay + inputs[DECAY_INPUT].getPolyVoltageSimd<float_4>(c) * 0.1f, 0.01, 10.0);
+			volume[c / 4].process(args.sampleTime);
 
-		const float kickFrequency = std::max(10.0f, freq + bend * pitch.env);
-		const float phaseInc = clamp(args.sampleTime * kickFrequency / UPSAMPLE, 1e-6, 0.35f);
+			float_4 freq = params[TUNE_PARAM].getValue();
+			freq *= exp2_taylor5_bipolar(inputs[TUNE_INPUT].getPolyVoltageSimd<float_4>(c));
 
-		const float shape = clamp(inputs[SHAPE_INPUT].getVoltage() / 10.f + params[SHAPE_PARAM].getValue(), 0.0f, 1.0f) * 0.99f;
-		const float shapeB = (1.0f - shape) / (1.0f + shape);
-		const float shapeA = (4.0f * shape) / ((1.0f - shape) * (1.0f + shape));
+			const float_4 kickFrequency = simd::fmax(10.0f, freq + bend * pitch[c / 4].env);
+			const float_4 phaseInc = simd::clamp(args.sampleTime * kickFrequency / UPSAMPLE, 1e-6, 0.35f);
 
-		float* inputBuf = oversampler.getOSBuffer();
-		for (int i = 0; i < UPSAMPLE; ++i) {
-			phase += phaseInc;
-			phase -= std::floor(phase);
+			const float_4 shape = simd::clamp(inputs[SHAPE_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f + params[SHAPE_PARAM].getValue(), 0.0f, 1.0f) * 0.99f;
+			const float_4 shapeB = (1.0f - shape) / (1.0f + shape);
+			const float_4 shapeA = (4.0f * shape) / ((1.0f - shape) * (1.0f + shape));
 
-			inputBuf[i] = sin2pi_pade_05_5_4(phase);
-			inputBuf[i] = inputBuf[i] * (shapeA + shapeB) / ((std::abs(inputBuf[i]) * shapeA) + shapeB);
-		}
+			float_4* inputBuf = oversampler[c / 4].getOSBuffer();
+			for (int i = 0; i < UPSAMPLE; ++i) {
+				phase[c / 4] += phaseInc;
+				phase[c / 4] -= simd::floor(phase[c / 4]);
+
+				inputBuf[i] = sin2pi_pade_05_5_4(phase[c / 4]);
+				inputBuf[i] = inputBuf[i] * (shapeA + shapeB) / ((simd::abs(inputBuf[i]) * shapeA) + shapeB);
+			}
 
-		const float out = volume.env * oversampler.downsample() * 5.0f * vcaGain;
-		outputs[OUT_OUTPUT].setVoltage(out);
+			const float_4 out = volume[c / 4].env * oversampler[c / 4].downsample() * 5.0f * vcaGain;
+			outputs[OUT_OUTPUT].setVoltageSimd(out, c);
+
+			maxEnv = simd::fmax(maxEnv, simd::ifelse(float_4(c, c + 1, c + 2, c + 3) < channels, volume[c / 4].env, 0.f));
+		}
+		outputs[OUT_OUTPUT].setChannels(channels);
 
-		lights[ENV_LIGHT].setBrightness(volume.env);
+		lights[ENV_LIGHT].setBrightness(std::max({maxEnv[0], maxEnv[1], maxEnv[2], maxEnv[3]}));
 	}
 };
 
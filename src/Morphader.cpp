@@ -2,17 +2,17 @@
 
 using simd::float_4;
 
-// equal sum crossfade, -1 <= p <= 1
-template <typename T>
-inline T equalSumCrossfade(T a, T b, const float p) {
-	return a * (0.5f * (1.f - p)) + b * (0.5f * (1.f + p));
+// equal sum crossfade gains for A and B, -1 <= p <= 1
+inline void equalSumCrossfadeGains(float_4 p, float_4& gainA, float_4& gainB) {
+	gainA = 0.5f * (1.f - p);
+	gainB = 0.5f * (1.f + p);
 }
 
-// equal power crossfade, -1 <= p <= 1
-template <typename T>
-inline T equalPowerCrossfade(T a, T b, const float p) {
-	//return std::min(std::exp(4.f * p), 1.f) * b + std::min(std::exp(4.f * -p), 1.f) * a;
-	return std::min(exponentialBipolar80Pade_5_4(p + 1), 1.f) * b + std::min(exponentialBipolar80Pade_5_4(1 - p), 1.f) * a;
+// equal power crossfade gains for A and B, -1 <= p <= 1
+inline void equalPowerCrossfadeGains(float_4 p, float_4& gainA, float_4& gainB) {
+	//gainA = simd::fmin(simd::exp(4.f * -p), 1.f), gainB = simd::fmin(simd::exp(4.f * p), 1.f);
+	gainA = simd::fmin(exponentialBipolar80Pade_5_4(1.f - p), 1.f);
+	gainB = simd::fmin(exponentialBipolar80Pade_5_4(p + 1.f), 1.f);
 }
 
 // TExponentialSlewLimiter doesn't appear to work as is required for this application.
@@ -110,42 +110,28 @@ struct Morphader : Module {
 		configParam(FADER_PARAM, -1.f, 1.f, 0.f, "Fader");
 	}
 
-	// determine the cross-fade between -1 (A) and +1 (B) for each of the 4 channels
+	// determine the cross-fade between -1 (A) and +1 (B) for each of the 4 channels (one per lane)
 	float_4 determineChannelCrossfades(const float deltaTime) {
 
-		float_4 channelCrossfades = {};
 		const float slewLambda = 2.0f / params[FADER_LAG_PARAM].getValue();
 		slewLimiter.setSlew(slewLambda);
 		const float masterCrossfadeValue = slewLimiter.process(deltaTime, params[FADER_PARAM].getValue());
 
+		float_4 crossfadeCV = {};
+		float_4 ownCV = {};
 		for (int i = 0; i < NUM_MIXER_CHANNELS; i++) {
-
-			if (i == 0) {
-				// CV will be added to master for channel 1, and if not connected, the normalled value of 5.0V will correspond to the midpoint
-				const float crossfadeCV = clamp(inputs[CV_INPUT + i].getVoltage(), 0.f, 10.f);
-				channelCrossfades[i] = params[CV_PARAM].getValue() * rescale(crossfadeCV, 0.f, 10.f, 0.f, +2.f) + masterCrossfadeValue;
-			}
-			else {
-				// if present for the current channel, CV has total control (crossfader is ignored)
-				if (inputs[CV_INPUT + i].isConnected()) {
-					const float crossfadeCV = clamp(inputs[CV_INPUT + i].getVoltage(), 0.f, 10.f);
-					channelCrossfades[i] = rescale(crossfadeCV, 0.f, 10.f, -1.f, +1.f);
-				}
-				// if channel 1 is plugged in, but this channel isn't, channel 1 is normalled - in
-				// this scenario, however the CV is summed with the crossfader
-				else if (inputs[CV_INPUT + 0].isConnected()) {
-					const float crossfadeCV = clamp(inputs[CV_INPUT + 0].getVoltage(), 0.f, 10.f);
-					channelCrossfades[i] = params[CV_PARAM].getValue() * rescale(crossfadeCV, 0.f, 10.f, 0.f, +2.f) + masterCrossfadeValue;
-				}
-				else {
-					channelCrossfades[i] = masterCrossfadeValue;
-				}
-			}
-
-			channelCrossfades[i] = clamp(channelCrossfades[i], -1.f, +1.f);
+			crossfadeCV[i] = inputs[CV_INPUT + i].getVoltage();
+			// if present for channels 2-4, CV has total control (crossfader is ignored)
+			ownCV[i] = (i > 0 && inputs[CV_INPUT + i].isConnected()) ? float_4::mask()[0] : 0.f;
 		}
+		crossfadeCV = simd::clamp(crossfadeCV, 0.f, 10.f);
+
+		// CV will be added to master for channel 1 (where an unpatched input reads 0V, leaving just the crossfader), and
+		// it is normalled to unpatched channels 2-4, where it is also summed with the crossfader
+		const float summed = params[CV_PARAM].getValue() * rescale(crossfadeCV[0], 0.f, 10.f, 0.f, +2.f) + masterCrossfadeValue;
+		const float_4 direct = simd::rescale(crossfadeCV, 0.f, 10.f, -1.f, +1.f);
 
-		return channelCrossfades;
+		return simd::clamp(simd::ifelse(ownCV, direct, summed), -1.f, +1.f);
 	}
 
 	void process(const ProcessArgs& args) override {
@@ -154,6 +140,12 @@ struct Morphader : Module {
 		float_4 mix[4] = {};
 		const float_4 channelCrossfades = determineChannelCrossfades(args.sampleTime);
 
+		// the crossfade curves only depend on the crossfade positions, so evaluate them once per sample, for all four
+		// channels at once (one per lane), rather than per channel and voice
+		float_4 sumGainA, sumGainB, powerGainA, powerGainB;
+		equalSumCrossfadeGains(channelCrossfades, sumGainA, sumGainB);
+		equalPowerCrossfadeGains(channelCrossfades, powerGainA, powerGainB);
+
 		for (int i = 0; i < NUM_MIXER_CHANNELS; i++) {
 
 			const int channels = std::max(std::max(inputs[A_INPUT + i].getChannels(), inputs[B_INPUT + i].getChannels()), 1);
@@ -163,27 +155,37 @@ struct Morphader : Module {
 				maxChannels = std::max(maxChannels, channels);
 			}
 
+			float gainA = 0.f, gainB = 0.f;
+			switch (static_cast<CrossfadeMode>(params[MODE + i].getValue())) {
+				case CV_MODE: {
+					gainA = sumGainA[i];
+					gainB = sumGainB[i];
+					break;
+				}
+				case AUDIO_MODE: {
+					// in audio mode, close to the centre point it is possible to get large voltages
+					// (e.g. if A and B are both 10V const). however according to the standard, it is
+					// better not to clip this https://vcvrack.com/manual/VoltageStandards#Output-Saturation
+					gainA = powerGainA[i];
+					gainB = powerGainB[i];
+					break;
+				}
+				default: {
+					break;
+				}
+			}
+			lights[A_LED + i].setBrightness(gainA);
+			lights[B_LED + i].setBrightness(gainB);
+
+			// fold the levels into the crossfade gains
+			gainA *= params[A_LEVEL + i].getValue();
+			gainB *= params[B_LEVEL + i].getValue();
+
 			float_4 out[4] = {};
 			for (int c = 0; c < channels; c += 4) {
-				float_4 inA = inputs[A_INPUT + i].getNormalVoltageSimd(normal10VSimd, c) * params[A_LEVEL + i].getValue();
-				float_4 inB = inputs[B_INPUT + i].getNormalVoltageSimd(normal10VSimd, c) * params[B_LEVEL + i].getValue();
-
-				switch (static_cast<CrossfadeMode>(params[MODE + i].getValue())) {
-					case CV_MODE: {
-						out[c / 4] = equalSumCrossfade(inA, inB, channelCrossfades[i]);
-						break;
-					}
-					case AUDIO_MODE: {
-						// in audio mode, close to the centre point it is possible to get large voltages
-						// (e.g. if A and B are both 10V const). however according to the standard, it is
-						// better not to clip this https://vcvrack.com/manual/VoltageStandards#Output-Saturation
-						out[c / 4] = equalPowerCrossfade(inA, inB, channelCrossfades[i]);
-						break;
-					}
-					default: {
-						out[c / 4] = 0.f;
-					}
-				}
+				const float_4 inA = inputs[A_INPUT + i].getNormalVoltageSimd(normal10VSimd, c);
+				const float_4 inB = inputs[B_INPUT + i].getNormalVoltageSimd(normal10VSimd, c);
+				out[c / 4] = inA * gainA + inB * gainB;
 			}
 
 			// if output is patched, the channel is taken out of the mix
@@ -206,24 +208,6 @@ struct Morphader : Module {
 					outputs[OUT + i].setVoltageSimd(mix[c / 4], c);
 				}
 			}
-
-			switch (static_cast<CrossfadeMode>(params[MODE + i].getValue())) {
-				case AUDIO_MODE: {
-					lights[A_LED + i].setBrightness(equalPowerCrossfade(1.f, 0.f, channelCrossfades[i]));
-					lights[B_LED + i].setBrightness(equalPowerCrossfade(0.f, 1.f, channelCrossfades[i]));
-					break;
-				}
-				case CV_MODE: {
-					lights[A_LED + i].setBrightness(equalSumCrossfade(1.f, 0.f, channelCrossfades[i]));
-					lights[B_LED + i].setBrightness(equalSumCrossfade(0.f, 1.f, channelCrossfades[i]));
-					break;
-				}
-				default: {
-					lights[A_LED + i].setBrightness(0.f);
-					lights[B_LED + i].setBrightness(0.f);
-					break;
-				}
-			}
 		} // end loop over mixer channels
 	}
 };
@@ -54,6 +54,10 @@ struct MotionMTR : Module {
 	const int updateLEDRate = 16;
 	dsp::ClockDivider sliderUpdate;
 
+	ControlRateDivider controlRate;
+	LightDisplayType modes[3] = {};
+	ControlRateRamp<float> gains[3];
+
 	bool startingUp = true;
 	dsp::Timer startupTimer;
 
@@ -110,17 +114,24 @@ struct MotionMTR : Module {
 
 	void process(const ProcessArgs& args) override {
 
-		const LightDisplayType mode1 = (LightDisplayType) params[MODE1_PARAM].getValue();
-		const LightDisplayType mode2 = (LightDisplayType) params[MODE2_PARAM].getValue();
-		const LightDisplayType mode3 = (LightDisplayType) params[MODE3_PARAM].getValue();
+		// modes and (signed) gains are read at control rate, with the gains ramped in between
+		if (controlRate.process()) {
+			for (int i = 0; i < 3; ++i) {
+				modes[i] = (LightDisplayType) params[MODE1_PARAM + 2 * i].getValue();
+				controlRate.setTarget(gains[i], params[CTRL_1_PARAM + 2 * i].getValue() * (modes[i] == CV_INV ? -1 : +1));
+			}
+		}
+		const LightDisplayType mode1 = modes[0];
+		const LightDisplayType mode2 = modes[1];
+		const LightDisplayType mode3 = modes[2];
 
 		const float in1 = inputs[IN1_INPUT].getNormalVoltage(10.f * (mode1 != AUDIO || !break10VNormalForAudioMode));
 		const float in2 = inputs[IN2_INPUT].getNormalVoltage(10.f * (mode2 != AUDIO || !break10VNormalForAudioMode));
 		const float in3 = inputs[IN3_INPUT].getNormalVoltage(10.f * (mode3 != AUDIO || !break10VNormalForAudioMode));
 
-		const float out1 = in1 * params[CTRL_1_PARAM].getValue() * (mode1 == CV_INV ? -1 : +1);
-		const float out2 = in2 * params[CTRL_2_PARAM].getValue() * (mode2 == CV_INV ? -1 : +1);
-		float out3 = in3 * params[CTRL_3_PARAM].getValue() * (mode3 == CV_INV ? -1 : +1);
+		const float out1 = in1 * gains[0].process();
+		const float out2 = in2 * gains[1].process();
+		float out3 = in3 * gains[2].process();
 
 		if (!outputs[OUT1_OUTPUT].isConnected()) {
 			out3 += out1;
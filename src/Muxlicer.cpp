@@ -54,29 +54,32 @@ struct BefacoSwitchMomentary : SvgSwitch {
 // gate is generated at request time through getGate(), rather than during
 // process() - this means that different divisions of clock can be requested
 // at any point in time. In contrast, the division/multiplication setting for
-// ClockMultDiv cannot easily be changed _during_ a clock tick.
+// ClockMultDiv cannot easily be changed _during_ a clock tick. Time is counted
+// in samples, and the pulse length is kept as the exact fraction
+// dividedLength / multiplication, so subdivisions are sample accurate.
 struct MultiGateClock {
 
-	float remaining = 0.f;
-	float fullPulseLength = 0.f;
+	int64_t elapsed = 0;
+	int64_t dividedLength = 0;
+	int multiplication = 1;
 
-	/** Immediately disables the pulse */
-	void reset(float newfullPulseLength) {
-		fullPulseLength = newfullPulseLength;
-		remaining = fullPulseLength;
+	/** Starts a pulse of length newDividedLength / newMultiplication samples */
+	void reset(int64_t newDividedLength, int newMultiplication) {
+		dividedLength = newDividedLength;
+		multiplication = newMultiplication;
+		elapsed = 0;
 	}
 
-	/** Advances the state by `deltaTime`. Returns whether the pulse is in the HIGH state. */
-	bool process(float deltaTime) {
-		if (remaining > 0.f) {
-			remaining -= deltaTime;
-			return true;
-		}
-		return false;
+	/** Advances the state by one sample */
+	void process() {
+		elapsed++;
 	}
 
 	bool getGate(int gateMode) {
 
+		// remaining length of the pulse, in units of 1 / multiplication samples
+		const int64_t remaining = dividedLength - elapsed * multiplication;
+
 		if (gateMode == 0) {
 			// always on (special case)
 			return true;
@@ -86,95 +89,13 @@ struct MultiGateClock {
 			return false;
 		}
 
-		const float multiGateOnLength = fullPulseLength / ((gateMode > 0) ? (2.f * gateMode) : 1.0f);
-		const bool isOddPulse = int(floor(remaining / multiGateOnLength)) % 2;
+		// each of the 2 * gateMode subdivisions is dividedLength / (2 * gateMode) of these units long
+		const bool isOddPulse = (remaining * 2 * gateMode / dividedLength) % 2;
 
 		return isOddPulse;
 	}
 };
 
-
-// Class for generating a clock sequence after setting a clock multiplication or division,
-// given a stream of clock pulses as the "base" clock.
-// Implementation is heavily inspired by BogAudio RGate, with modification
-struct MultDivClock {
-
-	// convention: negative values are used for division (1/mult), positive for multiplication (x mult)
-	// multDiv = 0 should not be used, but if it is it will result in no modification to the clock
-	int multDiv = 1;
-	float secondsSinceLastClock = -1.0f;
-	float inputClockLengthSeconds = -1.0f;
-
-	// count how many divisions we've had
-	int dividerCount = 0;
-
-	float dividedProgressSeconds = 0.f;
-
-	// returns the gated clock signal, returns true when high
-	bool process(float deltaTime, bool clockPulseReceived) {
-
-		if (clockPulseReceived) {
-			// update our record of the incoming clock spacing
-			if (secondsSinceLastClock > 0.0f) {
-				inputClockLengthSeconds = secondsSinceLastClock;
-			}
-			secondsSinceLastClock = 0.0f;
-		}
-
-		bool out = false;
-		if (secondsSinceLastClock >= 0.0f) {
-			secondsSinceLastClock += deltaTime;
-
-			// negative values are used for division (x 1/mult), positive for multiplication (x mult)
-			const int division = std::max(-multDiv, 1);
-			const int multiplication = std::max(multDiv, 1);
-
-			if (clockPulseReceived) {
-				if (dividerCount < 1) {
-					dividedProgressSeconds = 0.0f;
-				}
-				else {
-					dividedProgressSeconds += deltaTime;
-				}
-				++dividerCount;
-				if (dividerCount >= division) {
-					dividerCount = 0;
-				}
-			}
-			else {
-				dividedProgressSeconds += deltaTime;
-			}
-
-			// lengths of the mult/div versions of the clock
-			const float dividedSeconds = inputClockLengthSeconds * (float) division;
-			const float multipliedSeconds = dividedSeconds / (float) multiplication;
-
-			// length of the output gate (s)
-			const float gateSeconds = std::max(0.001f, multipliedSeconds * 0.5f);
-
-			if (dividedProgressSeconds < dividedSeconds) {
-				float multipliedProgressSeconds = dividedProgressSeconds / multipliedSeconds;
-				multipliedProgressSeconds -= (float)(int)multipliedProgressSeconds;
-				multipliedProgressSeconds *= multipliedSeconds;
-				out = (multipliedProgressSeconds <= gateSeconds);
-			}
-		}
-		return out;
-	}
-
-	float getEffectiveClockLength() {
-		// negative values are used for division (x 1/mult), positive for multiplication (x mult)
-		const int division = std::max(-multDiv, 1);
-		const int multiplication = std::max(multDiv, 1);
-
-		// lengths of the mult/div versions of the clock
-		const float dividedSeconds = inputClockLengthSeconds * (float) division;
-		const float multipliedSeconds = dividedSeconds / (float) multiplication;
-
-		return multipliedSeconds;
-	}
-};
-
 static const std::vector<int> clockOptionsQuadratic = {-16, -8, -4, -2, 1, 2, 4, 8, 16};
 static const std::vector<int> clockOptionsAll = {-16, -15, -14, -13, -12, -11, -10, -9, -8, -7, -6, -5, -4, -3, -2, 1,
                                                  2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16
@@ -270,11 +191,10 @@ struct Muxlicer : Module {
 	dsp::BooleanTrigger detectResetTrigger;
 
 	// used to track the clock (e.g. if external clock is not connected). NOTE: this clock
-	// is defined _prior_ to any clock division/multiplication logic
-	float internalClockProgress = 0.f;
-	float internalClockLength = 0.25f;
-
-	float tapTime = 99999;	// used to track the time between clock pulses (or taps?)
+	// is defined _prior_ to any clock division/multiplication logic. Its pulse spacing is
+	// used to track the time between clock pulses (or taps)
+	SampleClock internalClock;
+	float sampleRate = 44100.f;
 	dsp::SchmittTrigger inputClockTrigger;	// to detect incoming clock pulses
 	dsp::BooleanTrigger mainClockTrigger;	// to detect when divided/multiplied version of the clock signal has rising edge
 	dsp::SchmittTrigger resetTrigger; 		// to detect the reset signal
@@ -399,12 +319,15 @@ struct Muxlicer : Module {
 		configInput(Muxlicer::COM_INPUT, "COM I/O");
 		configInput(Muxlicer::ALL_INPUT, "All");
 
+		sampleRate = APP->engine->getSampleRate();
 		onReset();
 	}
 
 	void onReset() override {
-		internalClockLength = 0.250f;
-		internalClockProgress = 0;
+		internalClock.period = std::round(0.250f * sampleRate);
+		internalClock.elapsed = 0;
+		// long enough ago that the first tap doesn't set the tempo
+		internalClock.samplesSincePulse = INT32_MAX;
 		runIndex = 0;
 		mainClockMultDiv.multDiv = 1;
 		outputClockMultDiv.multDiv = 1;
@@ -412,6 +335,13 @@ struct Muxlicer : Module {
 		playState = STATE_STOPPED;
 	}
 
+	void onSampleRateChange() override {
+		// keep the internal tempo (in seconds) when the sample rate changes
+		const float newSampleRate = APP->engine->getSampleRate();
+		internalClock.rescale(newSampleRate / sampleRate);
+		sampleRate = newSampleRate;
+	}
+
 	void process(const ProcessArgs& args) override {
 
 		usingExternalClock = inputs[CLOCK_INPUT].isConnected();
@@ -440,44 +370,38 @@ struct Muxlicer : Module {
 		if (externalClockPulseReceived) {
 			// track length between received clock pulses (using external clock) or taps
 			// of the tap-tempo menu item (if sufficiently short)
-			if (usingExternalClock || tapTime < 2.f) {
-				internalClockLength = tapTime;
+			const int64_t tapSamples = internalClock.pulse();
+			if (usingExternalClock || tapSamples * args.sampleTime < 2.f) {
+				internalClock.period = std::max<int64_t>(tapSamples, 1);
 			}
-			tapTime = 0;
-			internalClockProgress = 0.f;
+			internalClock.sync();
 		}
 
 		// If we get a reset signal (which can come from CV or various modes of the switch), and the clock has only
-		// just started to tick (internalClockProgress < 1ms), we assume that the reset signal is slightly delayed
+		// just started to tick (less than 1ms since it ticked or was synced), we assume that the reset signal is slightly delayed
 		// due to the 1 sample delay that Rack introduces. If this is the case, the internal clock trigger detector,
 		// `detectResetTrigger`, which advances the sequence, will not be "primed" to detect a rising edge for another
 		// whole clock tick, meaning the first step is repeated. See: https://github.com/VCVRack/Befaco/issues/32
 		// Also see https://vcvrack.com/manual/VoltageStandards#Timing for 0.001 seconds justification.
-		if (detectResetTrigger.process(resetRequested != RESET_NOT_REQUESTED) && internalClockProgress < 1e-3) {
+		if (detectResetTrigger.process(resetRequested != RESET_NOT_REQUESTED) && internalClock.elapsed * args.sampleTime < 1e-3) {
 			// NOTE: the sequence must also be stopped for this to come into effect. In hardware, if the Nth step Gate Out
 			// is patched back into the reset, that step should complete before the sequence restarts.
 			if (playState == STATE_STOPPED) {
 				mainClockTrigger.state = false;
 			}
 		}
-		tapTime += args.sampleTime;
-		internalClockProgress += args.sampleTime;
-
 		// track if the internal clock has "ticked"
-		const bool internalClockPulseReceived = (internalClockProgress >= internalClockLength);
-		if (internalClockPulseReceived) {
-			internalClockProgress = 0.f;
-		}
+		const bool internalClockPulseReceived = internalClock.process();
 
 		// we can be in one of two clock modes:
 		// * external (decided by pulses to CLOCK_INPUT)
-		// * internal (decided by internalClockProgress exceeding the internal clock length)
+		// * internal (decided by the internal clock ticking)
 		//
 		// choose which clock source we are to use
 		const bool clockPulseReceived = usingExternalClock ? externalClockPulseReceived : internalClockPulseReceived;
 		// apply the main clock div/mult logic to whatever clock source we're using - mainClockMultDiv outputs a gate sequence
 		// so we must use a BooleanTrigger on the divided/mult'd signal in order to detect rising edge / when to advance the sequence
-		const bool dividedMultipliedClockPulseReceived = mainClockTrigger.process(mainClockMultDiv.process(args.sampleTime, clockPulseReceived));
+		const bool dividedMultipliedClockPulseReceived = mainClockTrigger.process(mainClockMultDiv.process(clockPulseReceived, args.sampleTime));
 
 		if (dividedMultipliedClockPulseReceived) {
 
@@ -519,7 +443,7 @@ struct Muxlicer : Module {
 				}
 			}
 
-			multiClock.reset(mainClockMultDiv.getEffectiveClockLength());
+			multiClock.reset(mainClockMultDiv.getDividedClockLength(), mainClockMultDiv.getMultiplication());
 
 			if (isAddressInRunMode) {
 				addressIndex = runIndex;
@@ -540,7 +464,7 @@ struct Muxlicer : Module {
 		}
 		outputs[ALL_GATES_OUTPUT].setVoltage(0.f);
 
-		multiClock.process(args.sampleTime);
+		multiClock.process();
 		const int gateMode = getGateMode();
 
 		// current gate output _and_ "All Gates" output both get the gate pattern from multiClock
@@ -595,7 +519,7 @@ struct Muxlicer : Module {
 		// there is an option to stop output clock when play stops
 		const bool playStateMask = !outputClockFollowsPlayMode || (playState != STATE_STOPPED);
 		// NOTE: outputClockOut can also be read by expanders
-		isOutputClockHigh = outputClockMultDiv.process(args.sampleTime, clockPulseReceived) && playStateMask;
+		isOutputClockHigh = outputClockMultDiv.process(clockPulseReceived, args.sampleTime) && playStateMask;
 		outputs[CLOCK_OUTPUT].setVoltage(isOutputClockHigh * 10.f);
 		lights[CLOCK_LIGHT].setBrightness(isOutputClockHigh * 1.f);
 
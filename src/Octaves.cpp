@@ -50,12 +50,27 @@ struct Octaves : Module {
 	static const int NUM_OUTPUTS = 6;
 	const float ranges[3] = {4.f, 1.f, 1.f / 12.f}; 	// full, octave, semitone
 
-	float_4 phase[4] = {};		// phase for core waveform, in [0, 1]
+	int32_4 phase[4] = {};		// phase for core waveform, as 32-bit fixed point (0x80000000 is half a cycle)
 	chowdsp::VariableOversampling<6, float_4> oversampler[NUM_OUTPUTS][4]; 	// uses a 2*6=12th order Butterworth filter
 	int oversamplingIndex = 2; 	// default is 2^oversamplingIndex == x4 oversampling
 
+	enum AntialiasingMode {
+		// naive waveforms, run at the selected oversampling ratio
+		OVERSAMPLED,
+		// minBLEP corrected square edges, always at 1x
+		MINBLEP
+	};
+	AntialiasingMode antialiasingMode = OVERSAMPLED;
+	// minBLEP mode only, one per octave and voice group
+	dsp::MinBlepGenerator<16, 32, float_4> squareMinBlep[NUM_OUTPUTS][4];
+
 	DCBlockerT<2, float_4> blockDCFilter[NUM_OUTPUTS][4];			// optionally block DC with RC filter @ ~22 Hz
-	dsp::TSchmittTrigger<float_4> syncTrigger[4]; 	// for hard sync
+	HardSync_4 hardSync[4]; 	// for hard sync
+
+	// a voice group with all gains at zero sleeps once it has been silent long enough for the anti-aliasing filters (and
+	// minBLEP residuals) to have rung out
+	static const int SLEEP_HANGOVER = 64;
+	int silentSamples[4] = {};
 
 	Octaves() {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
@@ -133,52 +148,96 @@ struct Octaves : Module {
 			// pwm in [-0.25 : +0.25]
 			const float_4 pwm = 2 * clamp(0.5 - params[PWM_PARAM].getValue() + 0.5 * pwmCV, -0.5f + pulseWidthLimit, 0.5f - pulseWidthLimit);
 
-			const int oversamplingRatio = oversampler[0][0].getOversamplingRatio();
+			const int oversamplingRatio = (antialiasingMode == MINBLEP) ? 1 : oversampler[0][0].getOversamplingRatio();
 
 			const float_4 deltaPhase = freq * args.sampleTime / oversamplingRatio;
+			const int32_4 deltaPhaseFixed = toFixed(deltaPhase);
+
+			// hard sync, detected at 1x: the crossing time picks the sub-sample where the reset (to half a cycle) lands, and
+			// what is left of that sub-sample after the crossing is how far the phase has already run on from there
+			float_4 syncFraction;
+			const float_4 syncMask = hardSync[c / 4].process(inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c), syncFraction);
+			const bool anySync = simd::movemask(syncMask);
+			const float_4 syncTime = syncFraction * oversamplingRatio;
 
-			//  process sync
-			float_4 sync = syncTrigger[c / 4].process(inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c));
-			phase[c / 4] = simd::ifelse(sync, 0.5f, phase[c / 4]);
+			const float_4 rising = risingEdge(pwm);
+			const float_4 falling = fallingEdge(pwm);
 
+			// gains only change once per sample, so read them outside the oversampling loop
+			float_4 gain[NUM_OUTPUTS];
+			bool octaveActive[NUM_OUTPUTS];
+			for (int oct = 0; oct <= highestOutput; oct++) {
+				const float_4 gainCV = simd::clamp(inputs[GAIN_01F_INPUT + oct].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.0f);
+				gain[oct] = params[GAIN_01F_PARAM + oct].getValue() * gainCV;
+
+				// don't bother processing if gain is zero and no output is connected
+				const bool isGainZero = simd::movemask(gain[oct] != 0.f) == 0;
+				octaveActive[oct] = !isGainZero || outputs[OUT_01F_OUTPUT + oct].isConnected();
+			}
+
+			// with every gain at zero all outputs are exactly zero, so once asleep only the phase needs to be kept running;
+			// the filters are left in the (decayed) state that zero input leaves them in, so waking needs no warm-up
+			bool groupSilent = true;
+			for (int oct = 0; oct <= highestOutput; oct++) {
+				groupSilent &= simd::movemask(gain[oct] != 0.f) == 0;
+			}
+			silentSamples[c / 4] = groupSilent ? std::min(silentSamples[c / 4] + 1, SLEEP_HANGOVER) : 0;
+			if (silentSamples[c / 4] == SLEEP_HANGOVER) {
+				for (int i = 0; i < oversamplingRatio; i++) {
+					phase[c / 4] += deltaPhaseFixed;
+				}
+				if (anySync) {
+					const int32_4 syncedPhase = int32_4(INT32_MIN) + toFixed((oversamplingRatio - syncTime) * deltaPhase);
+					phase[c / 4] ^= (phase[c / 4] ^ syncedPhase) & int32_4::cast(syncMask);
+				}
+				for (int oct = 0; oct <= highestOutput; oct++) {
+					if (outputs[OUT_01F_OUTPUT + oct].isConnected()) {
+						// DC blocker has a much longer tail, so keeps running
+						const float_4 out = removePulseDC ? blockDCFilter[oct][c / 4].process(0.f) : 0.f;
+						outputs[OUT_01F_OUTPUT + oct].setVoltageSimd(5.f * out, c);
+					}
+				}
+				continue;
+			}
+
+			if (antialiasingMode == MINBLEP) {
+				processMinBlep(c, std::min(4, numActivePolyphonyEngines - c), deltaPhase, deltaPhaseFixed, pwm, rising, falling,
+				               syncMask, syncFraction, gain, octaveActive, highestOutput);
+				continue;
+			}
+
+			const float_4 syncSubSample = simd::ifelse(syncMask, simd::ceil(syncTime) - 1.f, -1.f);
 
 			for (int i = 0; i < oversamplingRatio; i++) {
 
-				phase[c / 4] += deltaPhase;
-				phase[c / 4] -= simd::floor(phase[c / 4]);
+				// wraps around by integer overflow
+				phase[c / 4] += deltaPhaseFixed;
+
+				//  process sync
+				if (anySync) {
+					const int32_4 syncedPhase = int32_4(INT32_MIN) + toFixed((i + 1.f - syncTime) * deltaPhase);
+					phase[c / 4] ^= (phase[c / 4] ^ syncedPhase) & int32_4::cast(syncSubSample == float_4(i));
+				}
 
 				float_4 sum = {};
 				for (int oct = 0; oct <= highestOutput; oct++) {
 
-					const float_4 gainCV = simd::clamp(inputs[GAIN_01F_INPUT + oct].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.0f);
-					const float_4 gain = params[GAIN_01F_PARAM + oct].getValue() * gainCV;
-
-					// don't bother processing if gain is zero and no output is connected
-					const bool isGainZero = simd::movemask(gain != 0.f) == 0; 
-					if (isGainZero && !outputs[OUT_01F_OUTPUT + oct].isConnected()) {
+					if (!octaveActive[oct]) {
 						continue;
 					}
 
 					// derive phases for higher octaves from base phase (this keeps things in sync!)
-					const float_4 n = (float)(1 << oct);
-					// this is on [0, 1]
-					const float_4 effectivePhase = n * simd::fmod(phase[c / 4], 1 / n);
-					const float_4 waveTri = 1.0 - 2.0 * simd::abs(2.f * effectivePhase - 1.0);
-					// build square from triangle + comparator
-					const float_4 waveSquare = simd::ifelse(waveTri > pwm, +1.f, -1.f);
-
-					sum += (useTriangleCore ? waveTri : waveSquare) * gain;
+					const float_4 effectivePhase = octavePhase(phase[c / 4], oct);
+					const float_4 waveTri = triangle(effectivePhase);
+					const float_4 waveSquare = square(effectivePhase, rising, falling);
+
+					sum += (useTriangleCore ? waveTri : waveSquare) * gain[oct];
 					sum = clamp(sum, -1.f, 1.f);
 
 					if (outputs[OUT_01F_OUTPUT + oct].isConnected()) {
 						oversampler[oct][c/4].getOSBuffer()[i] = sum;
 						sum = 0.f;
-
-						// DEBUG("here %f %f %f %f %f", phase[c/4][0], waveTri[0], sum[0], gain[0], gainCV[0]);
 					}
-
-					
-
 				}
 
 			} // end of oversampling loop
@@ -205,6 +264,112 @@ struct Octaves : Module {
 		}
 	}
 
+	/** Processes one voice group at 1x. Square edge times follow analytically from the shared phase, and each octave's
+	edges are corrected by its own minBLEP. The triangle core has no steps, so is left naive. */
+	void processMinBlep(int c, int numLanes, float_4 deltaPhase, int32_4 deltaPhaseFixed, float_4 pwm, float_4 rising,
+	                    float_4 falling, float_4 syncMask, float_4 syncFraction, const float_4* gain, const bool* octaveActive,
+	                    int highestOutput) {
+		const int g = c / 4;
+
+		// hard sync splits the sample in two: the phase runs freely up to the crossing, then on again from half a cycle
+		const bool anySync = simd::movemask(syncMask);
+		const float_4 runFraction = simd::ifelse(syncMask, syncFraction, 1.f);
+		const int32_4 oldPhase = phase[g];
+		const int32_4 phaseAtSync = anySync ? oldPhase + toFixed(runFraction * deltaPhase) : oldPhase + deltaPhaseFixed;
+		phase[g] = phaseAtSync;
+		if (anySync) {
+			const int32_4 syncedPhase = int32_4(INT32_MIN) + toFixed((1.f - syncFraction) * deltaPhase);
+			phase[g] ^= (phase[g] ^ syncedPhase) & int32_4::cast(syncMask);
+		}
+
+		float_4 sum = {};
+		for (int oct = 0; oct <= highestOutput; oct++) {
+
+			if (!octaveActive[oct]) {
+				continue;
+			}
+
+			const float_4 octaveDeltaPhase = deltaPhase * (float)(1 << oct);
+			// above Nyquist, all that is left of an octave after band-limiting is its mean (-pwm for the square, 0 for the triangle)
+			const float_4 belowNyquist = octaveDeltaPhase < 0.5f;
+			const float_4 effectivePhase = octavePhase(phase[g], oct);
+
+			float_4 wave;
+			if (useTriangleCore) {
+				wave = simd::ifelse(belowNyquist, triangle(effectivePhase), 0.f);
+			}
+			else {
+				// x is crossed if it lies in (start, end], and its position relative to the current sample is in (-1, 0];
+				// the segment ends `offset` samples before the current sample
+				auto insertEdges = [&](float_4 lanes, float_4 start, float_4 end, float_4 offset) {
+					const float_4 wrapped = end < start;
+					auto insertEdge = [&](float_4 x, float jump) {
+						const float_4 crossed = simd::ifelse(wrapped, (start < x) | (x <= end), (start < x) & (x <= end));
+						const float_4 distance = end - x + simd::ifelse(x > end, 1.f, 0.f);
+						const float_4 p = simd::fmax(-distance / octaveDeltaPhase - offset, -0.999f);
+						insertMinBlepDiscontinuities(squareMinBlep[oct][g], lanes & belowNyquist & crossed, p, jump, numLanes);
+					};
+					insertEdge(rising, +2.f);
+					insertEdge(falling, -2.f);
+				};
+
+				const float_4 phaseAtSyncOct = octavePhase(phaseAtSync, oct);
+				insertEdges(float_4::mask(), octavePhase(oldPhase, oct), phaseAtSyncOct, 1.f - runFraction);
+
+				if (anySync) {
+					// at the crossing each octave jumps to its value at the reset point, and then runs on from there
+					const float_4 syncOctavePhase = octavePhase(int32_4(INT32_MIN), oct);
+					insertMinBlepDiscontinuities(squareMinBlep[oct][g], syncMask & belowNyquist, syncFraction - 1.f,
+					                             square(syncOctavePhase, rising, falling) - square(phaseAtSyncOct, rising, falling), numLanes);
+					insertEdges(syncMask, syncOctavePhase, effectivePhase, 0.f);
+				}
+
+				wave = simd::ifelse(belowNyquist, square(effectivePhase, rising, falling) + squareMinBlep[oct][g].process(), -pwm);
+			}
+
+			sum += wave * gain[oct];
+			sum = clamp(sum, -1.f, 1.f);
+
+			if (outputs[OUT_01F_OUTPUT + oct].isConnected()) {
+				float_4 out = sum;
+				if (removePulseDC) {
+					out = blockDCFilter[oct][g].process(out);
+				}
+				outputs[OUT_01F_OUTPUT + oct].setVoltageSimd(5.f * out, c);
+				sum = 0.f;
+			}
+		}
+	}
+
+	// phase increment in 32-bit fixed point, wrapped onto [-0.5, 0.5] (exactly, for increments < 1) to fit a signed int
+	static int32_4 toFixed(float_4 deltaPhase) {
+		return int32_4((deltaPhase - simd::round(deltaPhase)) * 4294967296.f);
+	}
+
+	// the phase of an octave, frac(2^oct * phase), on [0, 1): shifting by oct bits multiplies by 2^oct and wraps,
+	// the top 23 bits then become the mantissa of a float on [1, 2)
+	static float_4 octavePhase(int32_4 phase, int oct) {
+		const int32_4 mantissa = ((phase << oct) >> 9) & int32_4(0x007FFFFF);
+		return float_4::cast(mantissa | int32_4(0x3F800000)) - 1.f;
+	}
+
+	static float_4 triangle(float_4 phase) {
+		return 1.0 - 2.0 * simd::abs(2.f * phase - 1.0);
+	}
+
+	// square from triangle + comparator (high when the triangle is above pwm) is high for phase in [risingEdge, fallingEdge)
+	static float_4 risingEdge(float_4 pwm) {
+		return 0.25f * (1.f + pwm);
+	}
+
+	static float_4 fallingEdge(float_4 pwm) {
+		return 0.25f * (3.f - pwm);
+	}
+
+	static float_4 square(float_4 phase, float_4 rising, float_4 falling) {
+		return simd::ifelse((phase >= rising) & (phase < falling), +1.f, -1.f);
+	}
+
 	// polyphony is defined by the largest number of active channels on voct, pwm or gain inputs
 	int getNumActivePolyphonyEngines() {
 		int activePolyphonyEngines = 1;
@@ -235,6 +400,7 @@ struct Octaves : Module {
 		json_object_set_new(rootJ, "limitPW", json_boolean(limitPW));
 		json_object_set_new(rootJ, "oversamplingIndex", json_integer(oversampler[0][0].getOversamplingIndex()));
 		json_object_set_new(rootJ, "useTriangleCore", json_boolean(useTriangleCore));
+		json_object_set_new(rootJ, "antialiasingMode", json_integer(antialiasingMode));
 
 		return rootJ;
 	}
@@ -261,6 +427,11 @@ struct Octaves : Module {
 		if (useTriangleCoreJ) {
 			useTriangleCore = json_boolean_value(useTriangleCoreJ);
 		}
+
+		json_t* antialiasingModeJ = json_object_get(rootJ, "antialiasingMode");
+		if (antialiasingModeJ) {
+			antialiasingMode = (AntialiasingMode) json_integer_value(antialiasingModeJ);
+		}
 	}
 };
 
@@ -319,6 +490,8 @@ struct OctavesWidget : ModuleWidget {
 		}
 		                                ));
 
+		menu->addChild(createIndexPtrSubmenuItem("Anti-aliasing", {"Oversampled", "minBLEP (no oversampling)"}, &module->antialiasingMode));
+
 		menu->addChild(createIndexSubmenuItem("Oversampling",
 		{"Off", "x2", "x4", "x8"},
 		[ = ]() {
@@ -327,7 +500,8 @@ struct OctavesWidget : ModuleWidget {
 		[ = ](int mode) {
 			module->oversamplingIndex = mode;
 			module->onSampleRateChange();
-		}
+		},
+		module->antialiasingMode == Octaves::MINBLEP
 		                                     ));
 
 	}
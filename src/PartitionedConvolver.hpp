@@ -0,0 +1,423 @@
+#pragma once
+#include <rack.hpp>
+#include <pffft.h>
+#include <atomic>
+
+
+/** Float buffer with the 16 byte alignment that pffft requires, zero initialised */
+struct PffftBuffer {
+	float* data = nullptr;
+	size_t size = 0;
+
+	PffftBuffer() {}
+	PffftBuffer(const PffftBuffer&) = delete;
+	PffftBuffer& operator=(const PffftBuffer&) = delete;
+
+	~PffftBuffer() {
+		if (data) {
+			pffft_aligned_free(data);
+		}
+	}
+
+	void resize(size_t newSize) {
+		if (data) {
+			pffft_aligned_free(data);
+		}
+		size = newSize;
+		data = size ? (float*) pffft_aligned_malloc(size * sizeof(float)) : nullptr;
+		clear();
+	}
+
+	void clear() {
+		if (data) {
+			std::memset(data, 0, size * sizeof(float));
+		}
+	}
+
+	float* operator[](size_t offset) const {
+		return data + offset;
+	}
+};
+
+/** Partition layout, FFT setups and kernel spectra for a PartitionedConvolver.
+
+Immutable once constructed, so a single instance can be shared (via std::shared_ptr) between any number of
+convolvers using the same kernel, which then only hold their own input/output state.
+*/
+struct PartitionedKernel {
+	/** Block size of the head stage, which sets the latency of the convolver */
+	static const size_t HEAD_BLOCK_SIZE = 64;
+
+	struct Stage {
+		/** block size, FFT size is twice this */
+		size_t blockSize = 0;
+		/** offset of this stage's first partition into the kernel */
+		size_t offset = 0;
+		size_t numPartitions = 0;
+		/** head stage does all of its work at the block boundary */
+		bool immediate = false;
+
+		PFFFT_Setup* setup = nullptr;
+		/** kernel partition spectra, numPartitions * fftSize */
+		PffftBuffer spectra;
+
+		Stage() {}
+		Stage(const Stage&) = delete;
+		Stage& operator=(const Stage&) = delete;
+
+		~Stage() {
+			if (setup) {
+				pffft_destroy_setup(setup);
+			}
+		}
+
+		size_t fftSize() const {
+			return 2 * blockSize;
+		}
+
+		/** a job is a forward FFT, one complex multiply-accumulate per partition, then an inverse FFT */
+		size_t numItems() const {
+			return numPartitions + 2;
+		}
+	};
+
+	std::vector<std::unique_ptr<Stage>> stages;
+	/** largest block size of any stage */
+	size_t maxBlockSize = HEAD_BLOCK_SIZE;
+	/** how far ahead of the read position any stage writes its output */
+	size_t maxLookahead = HEAD_BLOCK_SIZE;
+
+	/** Computes the partition layout and kernel spectra. Allocates, so construct outside the audio thread. */
+	PartitionedKernel(const float* kernel, size_t length) {
+		// head: 64 up to 1024, then 512 up to 8192, then 4096 for the remainder
+		// each stage starts at (at least) twice its block size, so its work can be spread over one block
+		const size_t layout[][2] = {
+			{HEAD_BLOCK_SIZE, 1024},
+			{512, 8192},
+			{4096, SIZE_MAX},
+		};
+
+		size_t offset = 0;
+		for (const auto& l : layout) {
+			if (offset >= length) {
+				break;
+			}
+			const size_t blockSize = l[0];
+			const size_t end = std::min(l[1], length);
+
+			Stage* stage = new Stage;
+			stages.emplace_back(stage);
+			stage->blockSize = blockSize;
+			stage->offset = offset;
+			stage->numPartitions = (end - offset + blockSize - 1) / blockSize;
+			stage->immediate = (offset == 0);
+			assert(stage->immediate || offset >= 2 * blockSize);
+
+			const size_t fftSize = stage->fftSize();
+			stage->setup = pffft_new_setup(fftSize, PFFFT_REAL);
+			stage->spectra.resize(stage->numPartitions * fftSize);
+
+			// transform each zero padded partition of the kernel
+			PffftBuffer frame, work;
+			frame.resize(fftSize);
+			work.resize(fftSize);
+			for (size_t p = 0; p < stage->numPartitions; p++) {
+				const size_t start = offset + p * blockSize;
+				const size_t len = std::min(blockSize, length - start);
+				frame.clear();
+				std::memcpy(frame.data, kernel + start, len * sizeof(float));
+				pffft_transform(stage->setup, frame.data, stage->spectra[p * fftSize], work.data, PFFFT_FORWARD);
+			}
+
+			maxBlockSize = std::max(maxBlockSize, blockSize);
+			maxLookahead = std::max(maxLookahead, offset + blockSize + HEAD_BLOCK_SIZE);
+			offset += stage->numPartitions * blockSize;
+		}
+	}
+
+	PartitionedKernel(const PartitionedKernel&) = delete;
+	PartitionedKernel& operator=(const PartitionedKernel&) = delete;
+};
+
+/** Non-uniform partitioned overlap-save convolver, see Gardner, "Efficient Convolution without Input-Output Delay" (1995).
+
+The kernel is split into stages of increasing block size: a small head block sets the latency, and the later
+(larger) stages cover the rest of the kernel. A stage with block size N starts at least 2N samples into the
+kernel, so its FFT work for one block can be spread over the N samples in which the next block is being
+collected, rather than landing on a single sample. This keeps the per-sample CPU cost roughly flat.
+
+Multiple channels are convolved with the same kernel in lockstep: each unit of work is done for every
+channel in turn, so the FFT setup and each kernel partition are shared while they are hot in cache.
+*/
+struct PartitionedConvolver {
+	static const size_t HEAD_BLOCK_SIZE = PartitionedKernel::HEAD_BLOCK_SIZE;
+	static const int MAX_CHANNELS = 16;
+
+	/** per-channel, per-stage buffers */
+	struct ChannelStage {
+		/** frequency-domain delay line of input spectra, numPartitions * fftSize */
+		PffftBuffer fdl;
+		/** last 2 * blockSize input samples, captured at the block boundary */
+		PffftBuffer snapshot;
+		PffftBuffer accumulator;
+	};
+
+	struct Channel {
+		std::vector<std::unique_ptr<ChannelStage>> stages;
+		/** input history, long enough to snapshot the largest stage's FFT frame */
+		std::vector<float> inputRing;
+		/** output accumulator indexed by output time, stages add their blocks ahead of the read position */
+		std::vector<float> outputRing;
+	};
+
+	/** per-stage scheduling, shared by all channels as they run in lockstep */
+	struct StageState {
+		PffftBuffer work;
+		/** FDL slot holding the spectrum of the most recent block */
+		size_t fdlIndex = 0;
+		/** samples collected since the last block boundary */
+		size_t inputCount = 0;
+		/** position within the current job (in samples since the boundary), and output time it is for */
+		size_t jobTick = 0;
+		size_t jobItem = 0;
+		bool jobActive = false;
+		uint64_t jobTime = 0;
+	};
+
+	std::shared_ptr<const PartitionedKernel> kernel;
+	std::vector<std::unique_ptr<StageState>> states;
+	/** allocated channels (capacity reserved for MAX_CHANNELS, so never reallocated), only the first numChannels are processed */
+	std::vector<std::unique_ptr<Channel>> channels;
+	/** number of channels that are fully allocated, published after allocation so process() never sees a partial one */
+	std::atomic<int> numAllocated{0};
+	int numChannels = 0;
+
+	size_t inputMask = 0;
+	size_t outputMask = 0;
+	/** number of samples processed so far */
+	uint64_t time = 0;
+
+	PartitionedConvolver() {}
+	PartitionedConvolver(const PartitionedConvolver&) = delete;
+	PartitionedConvolver& operator=(const PartitionedConvolver&) = delete;
+
+	/** Allocates state for the given kernel, so call from outside the audio thread. */
+	void setKernel(std::shared_ptr<const PartitionedKernel> newKernel, int newChannels = 1) {
+		kernel = newKernel;
+		states.clear();
+		channels.clear();
+		numAllocated.store(0);
+		numChannels = 0;
+		time = 0;
+		if (!kernel) {
+			return;
+		}
+
+		for (const auto& stage : kernel->stages) {
+			StageState* state = new StageState;
+			states.emplace_back(state);
+			state->work.resize(stage->fftSize());
+		}
+		inputMask = nextPow2(2 * kernel->maxBlockSize) - 1;
+		outputMask = nextPow2(kernel->maxLookahead + 1) - 1;
+		channels.reserve(MAX_CHANNELS);
+
+		reserveChannels(newChannels);
+		setChannels(newChannels);
+	}
+
+	/** Allocates state for up to the given number of channels, so call from outside the audio thread. Safe while
+	process() runs on another thread (but not concurrently with setKernel()), as the channels vector never reallocates. */
+	void reserveChannels(int newChannels) {
+		newChannels = clamp(newChannels, 0, MAX_CHANNELS);
+		if (!kernel) {
+			return;
+		}
+
+		while ((int) channels.size() < newChannels) {
+			Channel* channel = new Channel;
+			channels.emplace_back(channel);
+			for (const auto& stage : kernel->stages) {
+				ChannelStage* channelStage = new ChannelStage;
+				channel->stages.emplace_back(channelStage);
+				channelStage->fdl.resize(stage->numPartitions * stage->fftSize());
+				channelStage->snapshot.resize(stage->fftSize());
+				channelStage->accumulator.resize(stage->fftSize());
+			}
+			channel->inputRing.assign(inputMask + 1, 0.f);
+			channel->outputRing.assign(outputMask + 1, 0.f);
+		}
+		numAllocated.store((int) channels.size(), std::memory_order_release);
+	}
+
+	/** Sets the number of channels processed, limited to those allocated by reserveChannels(). Never allocates. */
+	void setChannels(int newChannels) {
+		newChannels = clamp(newChannels, 0, numAllocated.load(std::memory_order_acquire));
+		if (newChannels == numChannels) {
+			return;
+		}
+
+		// channels coming back into use start from silence
+		for (int c = numChannels; c < newChannels; c++) {
+			resetChannel(*channels[c]);
+		}
+		numChannels = newChannels;
+	}
+
+	int getChannels() const {
+		return numChannels;
+	}
+
+	void reset() {
+		for (auto& channel : channels) {
+			resetChannel(*channel);
+		}
+		for (auto& state : states) {
+			state->fdlIndex = 0;
+			state->inputCount = 0;
+			state->jobActive = false;
+		}
+		time = 0;
+	}
+
+	/** Latency in samples between an input and the first tap of the kernel */
+	size_t getLatency() const {
+		return HEAD_BLOCK_SIZE - 1;
+	}
+
+	/** Processes one sample for each of the numChannels channels */
+	void process(const float* in, float* out) {
+		if (states.empty()) {
+			std::fill(out, out + numChannels, 0.f);
+			return;
+		}
+
+		for (int c = 0; c < numChannels; c++) {
+			channels[c]->inputRing[time & inputMask] = in[c];
+		}
+		time++;
+
+		for (size_t s = 0; s < states.size(); s++) {
+			const PartitionedKernel::Stage& stage = *kernel->stages[s];
+			StageState& state = *states[s];
+
+			if (++state.inputCount == stage.blockSize) {
+				startJob(s, stage, state);
+			}
+			if (state.jobActive) {
+				stepJob(s, stage, state);
+			}
+		}
+
+		// the head stage completes a block every HEAD_BLOCK_SIZE samples, so read that far behind
+		const size_t readIndex = (time - HEAD_BLOCK_SIZE) & outputMask;
+		for (int c = 0; c < numChannels; c++) {
+			float& y = channels[c]->outputRing[readIndex];
+			out[c] = y;
+			y = 0.f;
+		}
+	}
+
+	/** Processes a single (first) channel */
+	float process(float in) {
+		float out = 0.f;
+		if (numChannels == 1) {
+			process(&in, &out);
+		}
+		return out;
+	}
+
+private:
+	static size_t nextPow2(size_t n) {
+		size_t p = 1;
+		while (p < n) {
+			p <<= 1;
+		}
+		return p;
+	}
+
+	void resetChannel(Channel& channel) {
+		for (auto& channelStage : channel.stages) {
+			channelStage->fdl.clear();
+			channelStage->snapshot.clear();
+			channelStage->accumulator.clear();
+		}
+		std::fill(channel.inputRing.begin(), channel.inputRing.end(), 0.f);
+		std::fill(channel.outputRing.begin(), channel.outputRing.end(), 0.f);
+	}
+
+	void startJob(size_t s, const PartitionedKernel::Stage& stage, StageState& state) {
+		// the previous job is always finished by now, as its items are spread over exactly one block
+		state.inputCount = 0;
+		state.jobActive = true;
+		state.jobTick = 0;
+		state.jobItem = 0;
+		state.jobTime = time;
+
+		// overlap-save frame: the last two blocks of input
+		const size_t fftSize = stage.fftSize();
+		for (int c = 0; c < numChannels; c++) {
+			const std::vector<float>& inputRing = channels[c]->inputRing;
+			float* snapshot = channels[c]->stages[s]->snapshot.data;
+			for (size_t i = 0; i < fftSize; i++) {
+				snapshot[i] = inputRing[(time - fftSize + i) & inputMask];
+			}
+		}
+	}
+
+	void stepJob(size_t s, const PartitionedKernel::Stage& stage, StageState& state) {
+		const size_t numItems = stage.numItems();
+		size_t lastItem = numItems;
+		if (!stage.immediate) {
+			// spread items evenly over the block
+			lastItem = (state.jobTick + 1) * numItems / stage.blockSize;
+			state.jobTick++;
+		}
+
+		for (; state.jobItem < lastItem; state.jobItem++) {
+			processItem(s, stage, state, state.jobItem);
+		}
+
+		if (state.jobItem == numItems) {
+			state.jobActive = false;
+		}
+	}
+
+	void processItem(size_t s, const PartitionedKernel::Stage& stage, StageState& state, size_t item) {
+		const size_t fftSize = stage.fftSize();
+
+		if (item == 0) {
+			// forward FFT of the newest frame into the delay line
+			state.fdlIndex = (state.fdlIndex + stage.numPartitions - 1) % stage.numPartitions;
+			for (int c = 0; c < numChannels; c++) {
+				ChannelStage& channelStage = *channels[c]->stages[s];
+				pffft_transform(stage.setup, channelStage.snapshot.data, channelStage.fdl[state.fdlIndex * fftSize], state.work.data, PFFFT_FORWARD);
+				channelStage.accumulator.clear();
+			}
+		}
+		else if (item <= stage.numPartitions) {
+			// partition p is applied to the spectrum from p blocks ago
+			const size_t p = item - 1;
+			const size_t slot = (state.fdlIndex + p) % stage.numPartitions;
+			const float* spectrum = stage.spectra[p * fftSize];
+			for (int c = 0; c < numChannels; c++) {
+				ChannelStage& channelStage = *channels[c]->stages[s];
+				pffft_zconvolve_accumulate(stage.setup, channelStage.fdl[slot * fftSize], spectrum, channelStage.accumulator.data, 1.f / fftSize);
+			}
+		}
+		else {
+			// inverse FFT, the second half is the valid part of the overlap-save frame
+			const size_t blockSize = stage.blockSize;
+			const uint64_t start = state.jobTime - blockSize + stage.offset;
+			for (int c = 0; c < numChannels; c++) {
+				ChannelStage& channelStage = *channels[c]->stages[s];
+				pffft_transform(stage.setup, channelStage.accumulator.data, channelStage.snapshot.data, state.work.data, PFFFT_BACKWARD);
+
+				std::vector<float>& outputRing = channels[c]->outputRing;
+				for (size_t i = 0; i < blockSize; i++) {
+					outputRing[(start + i) & outputMask] += channelStage.snapshot.data[blockSize + i];
+				}
+			}
+		}
+	}
+};
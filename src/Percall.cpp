@@ -26,11 +26,14 @@ struct Percall : Module {
 		NUM_LIGHTS
 	};
 
-	ADEnvelope envs[4];
+	// per channel, one envelope per voice (in groups of 4), driven by the polyphonic trigger inputs
+	ADEnvelope_4 envs[4][4];
+	// number of envelope voices for each channel (i.e. trigger channels), a mono trigger drives every voice
+	int envelopeChannels[4] = {1, 1, 1, 1};
 
 	float gains[4] = {};
 
-	dsp::SchmittTrigger trigger[4];
+	SubSampleTrigger_4 trigger[4][4];
 	dsp::ClockDivider cvDivider;
 	dsp::ClockDivider lightDivider;
 	const int LAST_CHANNEL_ID = 3;
@@ -49,9 +52,11 @@ struct Percall : Module {
 			configInput(CV_INPUTS + i, string::f("Channel %d CV", i + 1));
 			configOutput(ENV_OUTPUTS + i, string::f("Channel %d envelope", i + 1));
 
-			envs[i].attackTime = attackTime;
-			envs[i].attackShape = 0.5f;
-			envs[i].decayShape = 2.0f;
+			for (int g = 0; g < 4; g++) {
+				envs[i][g].attackTime = attackTime;
+				envs[i][g].attackShape = 0.5f;
+				envs[i][g].decayShape = 2.0f;
+			}
 		}
 
 		configInput(STRENGTH_INPUT, string::f("Overall gain (also affects Env Outs)"));
@@ -64,6 +69,14 @@ struct Percall : Module {
 		lightDivider.setDivision(128);
 	}
 
+	// envelope for voice group g of channel i (nullptr if that channel has no envelope voices there)
+	ADEnvelope_4* getEnvelope(int i, int g) {
+		if (envelopeChannels[i] == 1) {
+			return &envs[i][0];
+		}
+		return (g * 4 < envelopeChannels[i]) ? &envs[i][g] : nullptr;
+	}
+
 	void process(const ProcessArgs& args) override {
 
 		float strength = 1.0f;
@@ -71,13 +84,20 @@ struct Percall : Module {
 			strength = std::sqrt(clamp(inputs[STRENGTH_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f));
 		}
 
+		for (int i = 0; i < 4; i++) {
+			envelopeChannels[i] = std::max(inputs[TRIG_INPUTS + i].getChannels(), 1);
+		}
+
 		// only calculate gains/decays every 16 samples
 		if (cvDivider.process()) {
 			for (int i = 0; i < 4; i++) {
 				gains[i] = std::pow(params[VOL_PARAMS + i].getValue(), 2.f) * strength;
 
-				float fallCv = inputs[CV_INPUTS + i].getVoltage() * 0.05f + params[DECAY_PARAMS + i].getValue();
-				envs[i].decayTime = rescale(std::pow(clamp(fallCv, 0.f, 1.0f), 2.f), 0.f, 1.f, minDecayTime, maxDecayTime);
+				for (int c = 0; c < envelopeChannels[i]; c += 4) {
+					const float_4 fallCv = inputs[CV_INPUTS + i].getPolyVoltageSimd<float_4>(c) * 0.05f + params[DECAY_PARAMS + i].getValue();
+					const float_4 fall = simd::clamp(fallCv, 0.f, 1.0f);
+					envs[i][c / 4].decayTime = simd::rescale(fall * fall, 0.f, 1.f, minDecayTime, maxDecayTime);
+				}
 			}
 		}
 
@@ -87,17 +107,27 @@ struct Percall : Module {
 		// Mixer channels
 		for (int i = 0; i < 4; i++) {
 
-			if (trigger[i].process(rescale(inputs[TRIG_INPUTS + i].getVoltage(), 0.1f, 2.f, 0.f, 1.f))) {
-				envs[i].trigger();
-			}
-			// if choke is enabled, and current channel is odd and left channel is in attack
-			if ((i % 2) && params[CHOKE_PARAMS + i / 2].getValue() && envs[i - 1].stage == ADEnvelope::STAGE_ATTACK) {
-				// TODO: is there a more graceful way to choke, e.g. rapid envelope?
-				// TODO: this will just silence it instantly, maybe switch to STAGE_DECAY and modify fall time
-				envs[i].stage = ADEnvelope::STAGE_OFF;
-			}
+			// if choke is enabled, and current channel is odd, voices are silenced while the same voice of the left channel is in attack
+			const bool choke = (i % 2) && params[CHOKE_PARAMS + i / 2].getValue();
+
+			for (int c = 0; c < envelopeChannels[i]; c += 4) {
+				const float_4 trig = inputs[TRIG_INPUTS + i].getPolyVoltageSimd<float_4>(c);
+				float_4 crossing;
+				const float_4 triggered = trigger[i][c / 4].process(trig, crossing);
+				// the attack starts from where the trigger crossed the threshold, between samples
+				envs[i][c / 4].trigger(triggered, SubSampleTrigger_4::getTimeSinceCrossing(crossing, args.sampleTime));
+
+				if (choke) {
+					// TODO: is there a more graceful way to choke, e.g. rapid envelope?
+					// TODO: this will just silence it instantly, maybe switch to STAGE_DECAY and modify fall time
+					const ADEnvelope_4* leftEnvelope = getEnvelope(i - 1, c / 4);
+					if (leftEnvelope) {
+						envs[i][c / 4].stop(leftEnvelope->attacking);
+					}
+				}
 
-			envs[i].process(args.sampleTime);
+				envs[i][c / 4].process(args.sampleTime);
+			}
 
 			int polyphonyChannels = 1;
 			float_4 in[4] = {};
@@ -105,7 +135,8 @@ struct Percall : Module {
 			bool inputIsNormed = !inputIsConnected && (i % 2) && inputs[CH_INPUTS + i - 1].isConnected();
 			if ((inputIsConnected || inputIsNormed)) {
 				int channelToReadFrom = inputIsNormed ? CH_INPUTS + i - 1 : CH_INPUTS + i;
-				polyphonyChannels = inputs[channelToReadFrom].getChannels();
+				// with polyphonic triggers, each trigger voice gets its own output voice (a mono input is shared by all)
+				polyphonyChannels = std::max(inputs[channelToReadFrom].getChannels(), envelopeChannels[i]);
 
 				// an input only counts towards the main output polyphony count if it's not taken out of the mix
 				// (i.e. an output is patched in). the final input should always count towards polyphony count.
@@ -113,11 +144,11 @@ struct Percall : Module {
 					maxPolyphonyChannels = std::max(maxPolyphonyChannels, polyphonyChannels);
 				}
 
-				// only process input audio if envelope is active
-				if (envs[i].stage != ADEnvelope::STAGE_OFF) {
-					float gain = gains[i] * envs[i].env;
-					for (int c = 0; c < polyphonyChannels; c += 4) {
-						in[c / 4] = inputs[channelToReadFrom].getVoltageSimd<float_4>(c) * gain;
+				for (int c = 0; c < polyphonyChannels; c += 4) {
+					const ADEnvelope_4* envelope = getEnvelope(i, c / 4);
+					// only process input audio if envelope is active
+					if (envelope && simd::movemask(envelope->env != 0.f)) {
+						in[c / 4] = inputs[channelToReadFrom].getPolyVoltageSimd<float_4>(c) * gains[i] * envelope->env;
 					}
 				}
 			}
@@ -154,13 +185,21 @@ struct Percall : Module {
 
 			// set env output
 			if (outputs[ENV_OUTPUTS + i].isConnected()) {
-				outputs[ENV_OUTPUTS + i].setVoltage(10.f * strength * envs[i].env);
+				outputs[ENV_OUTPUTS + i].setChannels(envelopeChannels[i]);
+				for (int c = 0; c < envelopeChannels[i]; c += 4) {
+					outputs[ENV_OUTPUTS + i].setVoltageSimd(10.f * strength * envs[i][c / 4].env, c);
+				}
 			}
 		}
 
 		if (lightDivider.process()) {
 			for (int i = 0; i < 4; i++) {
-				lights[LEDS + i].setBrightness(envs[i].env);
+				// show the loudest voice
+				float_4 env = 0.f;
+				for (int c = 0; c < envelopeChannels[i]; c += 4) {
+					env = simd::fmax(env, envs[i][c / 4].env);
+				}
+				lights[LEDS + i].setBrightness(std::max({env[0], env[1], env[2], env[3]}));
 			}
 		}
 
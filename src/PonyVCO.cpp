@@ -9,65 +9,97 @@ using simd::float_4;
 // * https://ccrma.stanford.edu/~jatin/Notebooks/adaa.html
 // * Pony waveshape  https://www.desmos.com/calculator/1kvahyl4ti
 
+// Both folds are odd functions (so their antiderivatives are even), which lets them be evaluated on |x| with a single
+// piecewise selection and the sign restored afterwards. F(xPrev) is carried over from the previous step rather than
+// recomputed, and the ill-conditioned fallback is only evaluated when some lane actually needs it.
 template<typename T>
 class FoldStage1 {
 public:
 
-	T process(T x, T xt) {
-		T y = simd::ifelse(simd::abs(x - xPrev) < 1e-5,
-		                   f(0.5 * (xPrev + x), xt),
-		                   (F(x, xt) - F(xPrev, xt)) / (x - xPrev));
+	// xt - threshold x, which only changes once per sample (rather than per sub-sample) so F(xPrev) is refreshed here
+	void setThreshold(T xt) {
+		this->xt = xt;
+		FPrev = F(xPrev, xt);
+	}
+
+	T process(T x) {
+		const T Fx = F(x, xt);
+		const T dx = x - xPrev;
+		T y = (Fx - FPrev) / dx;
+
+		const T illConditioned = simd::abs(dx) < 1e-5;
+		if (simd::movemask(illConditioned)) {
+			y = simd::ifelse(illConditioned, f(0.5 * (xPrev + x), xt), y);
+		}
 
 		xPrev = x;
+		FPrev = Fx;
 		return y;
 	}
 
-	// xt - threshold x
 	static T f(T x, T xt) {
-		return simd::ifelse(x > xt, +5 * xt - 4 * x, simd::ifelse(x < -xt, -5 * xt - 4 * x, x));
+		const T a = simd::abs(x);
+		const T y = simd::ifelse(a > xt, 5 * xt - 4 * a, a);
+		// restore sign of x
+		return y ^ (x & T(-0.f));
 	}
 
 	static T F(T x, T xt) {
-		return simd::ifelse(x > xt,  5 * xt * x - 2 * x * x - 2.5 * xt * xt,
-		                    simd::ifelse(x < -xt, -5 * xt * x - 2 * x * x - 2.5 * xt * xt, x * x / 2.f));
+		const T a = simd::abs(x);
+		return simd::ifelse(a > xt, xt * (5 * a - 2.5 * xt) - 2 * a * a, 0.5 * a * a);
 	}
 
 	void reset() {
 		xPrev = 0.f;
+		FPrev = 0.f;
 	}
 
 private:
+	T xt = 1.f;
 	T xPrev = 0.f;
+	T FPrev = 0.f;
 };
 
 template<typename T>
 class FoldStage2 {
 public:
 	T process(T x) {
-		const T y = simd::ifelse(simd::abs(x - xPrev) < 1e-5, f(0.5 * (xPrev + x)), (F(x) - F(xPrev)) / (x - xPrev));
+		const T Fx = F(x);
+		const T dx = x - xPrev;
+		T y = (Fx - FPrev) / dx;
+
+		const T illConditioned = simd::abs(dx) < 1e-5;
+		if (simd::movemask(illConditioned)) {
+			y = simd::ifelse(illConditioned, f(0.5 * (xPrev + x)), y);
+		}
+
 		xPrev = x;
+		FPrev = Fx;
 		return y;
 	}
 
+	// |x| is clipped to 2 + c, beyond which the fold is flat at -c
 	static T f(T x) {
-		return simd::ifelse(-(x + 2) > c, c, simd::ifelse(x < -1, -(x + 2), simd::ifelse(x < 1, x, simd::ifelse(-x + 2 > -c, -x + 2, -c))));
+		const T b = simd::fmin(simd::abs(x), 2.f + c);
+		const T y = simd::ifelse(b < 1, b, 2 - b);
+		// restore sign of x
+		return y ^ (x & T(-0.f));
 	}
 
 	static T F(T x) {
-		return simd::ifelse(x > 0, F_signed(x), F_signed(-x));
-	}
-
-	static T F_signed(T x) {
-		return simd::ifelse(x < 1, x * x * 0.5, simd::ifelse(x < 2.f + c, 2.f * x * (1.f - x * 0.25f) - 1.f,
-		                    2.f * (2.f + c) * (1.f - (2.f + c) * 0.25f) - 1.f - c * (x - 2.f - c)));
+		const T a = simd::abs(x);
+		const T b = simd::fmin(a, 2.f + c);
+		return simd::ifelse(b < 1, 0.5 * b * b, 1 - 0.5 * (b - 2) * (b - 2)) - c * (a - b);
 	}
 
 	void reset() {
 		xPrev = 0.f;
+		FPrev = 0.f;
 	}
 
 private:
 	T xPrev = 0.f;
+	T FPrev = 0.f;
 	static constexpr float c = 0.1f;
 };
 
@@ -116,7 +148,10 @@ struct PonyVCO : Module {
 	// hardware has DC for non-50% duty cycle, optionally add/remove it
 	bool removePulseDC = true;
 
-	dsp::TSchmittTrigger<float_4> syncTrigger[4];
+	HardSync_4 hardSync[4];
+	// the DPW only anti-aliases the waveform's own edges, so the step a sync reset causes is corrected with a minBLEP,
+	// inserted at its sub-sample position and run at the oversampled rate (so that it also covers 1x)
+	dsp::MinBlepGenerator<16, 32, float_4> syncMinBlep[4];
 
 	FoldStage1<float_4> stage1[4];
 	FoldStage2<float_4> stage2[4];
@@ -163,6 +198,13 @@ struct PonyVCO : Module {
 
 	float_4 phase[4] = {}; 	// phase at current (sub)sample
 
+	// voice groups sleep once their VCA has been closed for SLEEP_HANGOVER samples, so a VCA CV that only touches zero
+	// briefly never sleeps, and on waking warm up for as many samples as they slept (at most WAKE_WARMUP)
+	static const int SLEEP_HANGOVER = 64;
+	static const int WAKE_WARMUP = 32;
+	int silentSamples[4] = {};
+	int sleptSamples[4] = {};
+
 	void process(const ProcessArgs& args) override {
 
 		const int rangeIndex = params[RANGE_PARAM].getValue();
@@ -177,6 +219,7 @@ struct PonyVCO : Module {
 		const int channels = std::max({inputs[TZFM_INPUT].getChannels(), inputs[VOCT_INPUT].getChannels(), inputs[TIMBRE_INPUT].getChannels(), 1});
 
 		for (int c = 0; c < channels; c += 4) {
+			const int numLanes = std::min(4, channels - c);
 			const float_4 timbre = simd::clamp(params[TIMBRE_PARAM].getValue() + inputs[TIMBRE_INPUT].getPolyVoltageSimd<float_4>(c) / 10.f, 0.f, 1.f);
 
 			float_4 tzfmVoltage = inputs[TZFM_INPUT].getPolyVoltageSimd<float_4>(c);
@@ -186,7 +229,7 @@ struct PonyVCO : Module {
 			}
 
 			const float_4 pitch = inputs[VOCT_INPUT].getPolyVoltageSimd<float_4>(c) + params[FREQ_PARAM].getValue() * range[rangeIndex];
-			const float_4 freq = baseFreq * simd::pow(2.f, pitch);
+			const float_4 freq = baseFreq * exp2_taylor5_bipolar(pitch);
 			const float_4 deltaBasePhase = simd::clamp(freq * args.sampleTime / oversamplingRatio, -0.5f, 0.5f);
 			// floating point arithmetic doesn't work well at low frequencies, specifically because the finite difference denominator
 			// becomes tiny - we check for that scenario and use naive / 1st order waveforms in that frequency regime (as aliasing isn't
@@ -206,76 +249,121 @@ struct PonyVCO : Module {
 			// for it to be added back in for hardware compatibility reasons
 			const float_4 pulseDCOffset = (!removePulseDC) * 2.f * (0.5f - pw);
 
-			// hard sync
-			const float_4 syncMask = syncTrigger[c / 4].process(inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c));
-			if (waveform == WAVE_SIN) {
-				// hardware waveform is actually cos, so pi/2 phase offset is required
-				// - variable phase is defined on [0, 1] rather than [0, 2pi] so pi/2 -> 0.25
-				phase[c / 4] = simd::ifelse(syncMask, 0.25f, phase[c / 4]);
-			}
-			else {
-				phase[c / 4] = simd::ifelse(syncMask, 0.f, phase[c / 4]);
+			// hard sync, detected at 1x: the crossing time picks the sub-sample where the reset lands, and what is left of
+			// that sub-sample after the crossing is how far the phase has already run on from the reset point
+			float_4 syncFraction;
+			const float_4 syncMask = hardSync[c / 4].process(inputs[SYNC_INPUT].getPolyVoltageSimd<float_4>(c), syncFraction);
+			const bool anySync = simd::movemask(syncMask);
+			// hardware waveform is actually cos, so pi/2 phase offset is required
+			// - variable phase is defined on [0, 1] rather than [0, 2pi] so pi/2 -> 0.25
+			const float_4 syncPhase = (waveform == WAVE_SIN) ? 0.25f : 0.f;
+			const float_4 syncTime = syncFraction * oversamplingRatio;
+			const float_4 syncSubSample = simd::ifelse(syncMask, simd::ceil(syncTime) - 1.f, -1.f);
+
+			if (waveform != WAVE_PULSE) {
+				stage1[c / 4].setThreshold(1 - 0.85 * timbre);
 			}
 
-			float_4* osBuffer = oversampler[c / 4].getOSBuffer();
-			for (int i = 0; i < oversamplingRatio; ++i) {
-
-				phase[c / 4] += deltaBasePhase + deltaFMPhase;
-				// ensure within [0, 1]
-				phase[c / 4] -= simd::floor(phase[c / 4]);
+			// end of chain VCA
+			const float_4 gain = simd::clamp(inputs[VCA_INPUT].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.f);
 
-				// sin is simple
-				if (waveform == WAVE_SIN) {
-					osBuffer[i] = sin2pi_pade_05_5_4(phase[c / 4]);
+			// with the VCA fully closed the output is exactly zero, so the group sleeps and only its phase is kept running
+			const bool groupSilent = simd::movemask(gain != 0.f) == 0;
+			silentSamples[c / 4] = groupSilent ? std::min(silentSamples[c / 4] + 1, SLEEP_HANGOVER) : 0;
+			if (silentSamples[c / 4] == SLEEP_HANGOVER) {
+				phase[c / 4] += oversamplingRatio * (deltaBasePhase + deltaFMPhase);
+				if (anySync) {
+					phase[c / 4] = simd::ifelse(syncMask, syncPhase + (oversamplingRatio - syncTime) * (deltaBasePhase + deltaFMPhase), phase[c / 4]);
 				}
-				else {
-					float_4 phases[3]; // phase as extrapolated to the current and two previous samples
-
-					phases[0] = phase[c / 4] - 2 * deltaBasePhase + simd::ifelse(phase[c / 4] < 2 * deltaBasePhase, 1.f, 0.f);
-					phases[1] = phase[c / 4] - deltaBasePhase + simd::ifelse(phase[c / 4] < deltaBasePhase, 1.f, 0.f);
-					phases[2] = phase[c / 4];
+				phase[c / 4] -= simd::floor(phase[c / 4]);
+				sleptSamples[c / 4] = std::min(sleptSamples[c / 4] + 1, WAKE_WARMUP);
+				outputs[OUT_OUTPUT].setVoltageSimd(float_4::zero(), c);
+				continue;
+			}
 
-					switch (waveform) {
-						case WAVE_TRI: {
-							const float_4 dpwOrder1 = 1.0 - 2.0 * simd::abs(2 * phase[c / 4] - 1.0);
-							const float_4 dpwOrder3 = aliasSuppressedTri(phases) * denominatorInv;
+			// on waking, the anti-aliasing filter and wavefolder still hold state from before sleeping, so rewind the phase
+			// and run the samples slept through again (at the current settings), discarding the output: after a short
+			// sleep this costs no more than not having slept, and a long one is capped at WAKE_WARMUP samples
+			int numPasses = 1;
+			if (sleptSamples[c / 4] > 0) {
+				phase[c / 4] -= sleptSamples[c / 4] * oversamplingRatio * (deltaBasePhase + deltaFMPhase);
+				phase[c / 4] -= simd::floor(phase[c / 4]);
+				numPasses += sleptSamples[c / 4];
+				sleptSamples[c / 4] = 0;
+			}
 
-							osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-							break;
-						}
-						case WAVE_SAW: {
-							const float_4 dpwOrder1 = 2 * phase[c / 4] - 1.0;
-							const float_4 dpwOrder3 = aliasSuppressedSaw(phases) * denominatorInv;
+			float_4 out;
+			for (int pass = 0; pass < numPasses; pass++) {
+				float_4* osBuffer = oversampler[c / 4].getOSBuffer();
+				for (int i = 0; i < oversamplingRatio; ++i) {
+
+					phase[c / 4] += deltaBasePhase + deltaFMPhase;
+					// sync only lands in the real (last) pass, the warm-up passes lead up to it
+					const float_4 syncNow = (anySync && pass == numPasses - 1) ? (syncSubSample == float_4(i)) : float_4::zero();
+					if (simd::movemask(syncNow)) {
+						const float_4 syncResidual = (i + 1.f - syncTime) * (deltaBasePhase + deltaFMPhase);
+						float_4 phaseAtSync = phase[c / 4] - syncResidual;
+						phaseAtSync -= simd::floor(phaseAtSync);
+						insertMinBlepDiscontinuities(syncMinBlep[c / 4], syncNow, syncTime - (i + 1.f),
+						                             naiveWaveform(waveform, syncPhase, pw) - naiveWaveform(waveform, phaseAtSync, pw), numLanes);
+						phase[c / 4] = simd::ifelse(syncNow, syncPhase + syncResidual, phase[c / 4]);
+					}
+					// ensure within [0, 1]
+					phase[c / 4] -= simd::floor(phase[c / 4]);
 
-							osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-							break;
+					// sin is simple
+					if (waveform == WAVE_SIN) {
+						osBuffer[i] = sin2pi_pade_05_5_4(phase[c / 4]);
+					}
+					else {
+						float_4 phases[3]; // phase as extrapolated to the current and two previous samples
+
+						phases[0] = phase[c / 4] - 2 * deltaBasePhase + simd::ifelse(phase[c / 4] < 2 * deltaBasePhase, 1.f, 0.f);
+						phases[1] = phase[c / 4] - deltaBasePhase + simd::ifelse(phase[c / 4] < deltaBasePhase, 1.f, 0.f);
+						phases[2] = phase[c / 4];
+
+						switch (waveform) {
+							case WAVE_TRI: {
+								const float_4 dpwOrder1 = 1.0 - 2.0 * simd::abs(2 * phase[c / 4] - 1.0);
+								const float_4 dpwOrder3 = aliasSuppressedTri(phases) * denominatorInv;
+
+								osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
+								break;
+							}
+							case WAVE_SAW: {
+								const float_4 dpwOrder1 = 2 * phase[c / 4] - 1.0;
+								const float_4 dpwOrder3 = aliasSuppressedSaw(phases) * denominatorInv;
+
+								osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
+								break;
+							}
+							case WAVE_PULSE: {
+								float_4 dpwOrder1 = simd::ifelse(phase[c / 4] < 1. - pw, +1.0, -1.0);
+								dpwOrder1 -= removePulseDC ? 2.f * (0.5f - pw) : 0.f;
+
+								float_4 saw = aliasSuppressedSaw(phases);
+								float_4 sawOffset = aliasSuppressedOffsetSaw(phases, pw);
+								float_4 dpwOrder3 = (sawOffset - saw) * denominatorInv + pulseDCOffset;
+
+								osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
+								break;
+							}
+							default: break;
 						}
-						case WAVE_PULSE: {
-							float_4 dpwOrder1 = simd::ifelse(phase[c / 4] < 1. - pw, +1.0, -1.0);
-							dpwOrder1 -= removePulseDC ? 2.f * (0.5f - pw) : 0.f;
+					}
 
-							float_4 saw = aliasSuppressedSaw(phases);
-							float_4 sawOffset = aliasSuppressedOffsetSaw(phases, pw);
-							float_4 dpwOrder3 = (sawOffset - saw) * denominatorInv + pulseDCOffset;
+					osBuffer[i] += syncMinBlep[c / 4].process();
 
-							osBuffer[i] = simd::ifelse(lowFreqRegime, dpwOrder1, dpwOrder3);
-							break;
-						}
-						default: break;
+					if (waveform != WAVE_PULSE) {
+						osBuffer[i] = wavefolder(osBuffer[i], c);
 					}
-				}
 
-				if (waveform != WAVE_PULSE) {
-					osBuffer[i] = wavefolder(osBuffer[i], (1 - 0.85 * timbre), c);
-				}
-
-			} 	// end of oversampling loop
+				} 	// end of oversampling loop
 
-			// downsample (if required)
-			const float_4 out = (oversamplingRatio > 1) ? oversampler[c / 4].downsample() : osBuffer[0];
+				// downsample (if required)
+				out = (oversamplingRatio > 1) ? oversampler[c / 4].downsample() : osBuffer[0];
+			}
 
-			// end of chain VCA
-			const float_4 gain = simd::clamp(inputs[VCA_INPUT].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.f);
 			outputs[OUT_OUTPUT].setVoltageSimd(5.f * out * gain, c);
 
 		} 	// end of channels loop
@@ -283,6 +371,17 @@ struct PonyVCO : Module {
 		outputs[OUT_OUTPUT].setChannels(channels);
 	}
 
+	// waveform (before the wavefolder) without anti-aliasing, to size the step that a sync reset causes
+	static float_4 naiveWaveform(Waveform waveform, float_4 phase, float_4 pw) {
+		switch (waveform) {
+			case WAVE_SIN: return sin2pi_pade_05_5_4(phase);
+			case WAVE_TRI: return 1.0 - 2.0 * simd::abs(2 * phase - 1.0);
+			case WAVE_SAW: return 2 * phase - 1.0;
+			case WAVE_PULSE: return simd::ifelse(phase < 1. - pw, +1.0, -1.0);
+			default: return 0.f;
+		}
+	}
+
 	float_4 aliasSuppressedTri(float_4* phases) {
 		float_4 triBuffer[3];
 		for (int i = 0; i < 3; ++i) {
@@ -315,8 +414,8 @@ struct PonyVCO : Module {
 		return (sawOffsetBuff[0] - 2.0 * sawOffsetBuff[1] + sawOffsetBuff[2]);
 	}
 
-	float_4 wavefolder(float_4 x, float_4 xt, int c) {
-		return stage2[c / 4].process(stage1[c / 4].process(x, xt));
+	float_4 wavefolder(float_4 x, int c) {
+		return stage2[c / 4].process(stage1[c / 4].process(x));
 	}
 
 	json_t* dataToJson() override {
@@ -2,17 +2,38 @@
 
 using simd::float_4;
 
-static float_4 shapeDelta(float_4 delta, float_4 tau, float shape) {
-	float_4 lin = simd::sgn(delta) * 10.f / tau;
-	if (shape < 0.f) {
-		float_4 log = simd::sgn(delta) * 40.f / tau / (simd::fabs(delta) + 1.f);
-		return simd::crossfade(lin, log, -shape * 0.95f);
+/** The slope of a ramp towards its target, as a crossfade (set by shape) of a linear slope with a log one (shape < 0) or
+an exponential one (shape > 0). Each curve is linear in its crossfade weight, so for a given shape the crossfade reduces to
+a single expression, sgn(delta) * (lin + log / (|delta| + 1)) + exp * delta, whose coefficients only change with shape. */
+struct RampShape {
+	float lin = 10.f;
+	float log = 0.f;
+	float exp = 0.f;
+
+	void setShape(float shape) {
+		if (shape < 0.f) {
+			const float amount = -shape * 0.95f;
+			lin = 10.f * (1.f - amount);
+			log = 40.f * amount;
+			exp = 0.f;
+		}
+		else {
+			const float amount = shape * 0.90f;
+			lin = 10.f * (1.f - amount);
+			log = 0.f;
+			exp = M_E * amount;
+		}
 	}
-	else {
-		float_4 exp = M_E * delta / tau;
-		return simd::crossfade(lin, exp, shape * 0.90f);
+
+	/** tauInv is 1 / the time constant of the ramp */
+	float_4 process(float_4 delta, float_4 tauInv) const {
+		float_4 slope = lin;
+		if (log != 0.f) {
+			slope += log / (simd::fabs(delta) + 1.f);
+		}
+		return (simd::sgn(delta) * slope + exp * delta) * tauInv;
 	}
-}
+};
 
 struct Rampage : Module {
 	enum ParamIds {
@@ -77,7 +98,7 @@ struct Rampage : Module {
 	float_4 out[2][4] = {};
 	float_4 gate[2][4] = {}; // use simd __m128 logic instead of bool
 
-	dsp::TSchmittTrigger<float_4> trigger_4[2][4];
+	SubSampleTrigger_4 trigger_4[2][4];
 	PulseGenerator_4 endOfCyclePulse[2][4];
 
 	// ChannelMask channelMask;
@@ -122,6 +143,13 @@ struct Rampage : Module {
 		configOutput(COMPARATOR_OUTPUT, "B > A");
 		configOutput(MIN_OUTPUT, "Minimum of A and B");
 		configOutput(MAX_OUTPUT, "Maximum of A and B");
+
+		for (int part = 0; part < 2; part++) {
+			for (int g = 0; g < 4; g++) {
+				// i.e. 0.1V / 2V after halving the input
+				trigger_4[part][g] = SubSampleTrigger_4(0.2f, 4.f);
+			}
+		}
 	}
 
 	void process(const ProcessArgs& args) override {
@@ -155,12 +183,6 @@ struct Rampage : Module {
 		// loop over two parts of Rampage:
 		for (int part = 0; part < 2; part++) {
 
-			float_4 in[4] = {};
-			float_4 in_trig[4] = {};
-			float_4 riseCV[4] = {};
-			float_4 fallCV[4] = {};
-			float_4 cycle[4] = {};
-
 			// get parameters:
 			float minTime;
 			switch ((int) params[RANGE_A_PARAM + part].getValue()) {
@@ -175,83 +197,67 @@ struct Rampage : Module {
 					break;
 			}
 
-			float_4 param_rise  = params[RISE_A_PARAM  + part].getValue() * 10.0f;
-			float_4 param_fall  = params[FALL_A_PARAM  + part].getValue() * 10.0f;
-			float_4 param_trig  = params[TRIGG_A_PARAM + part].getValue() * 20.0f;
-			float_4 param_cycle = params[CYCLE_A_PARAM + part].getValue() * 10.0f;
+			const float param_rise  = params[RISE_A_PARAM  + part].getValue() * 10.0f;
+			const float param_fall  = params[FALL_A_PARAM  + part].getValue() * 10.0f;
+			const float param_trig  = params[TRIGG_A_PARAM + part].getValue() * 20.0f;
+			const float param_cycle = params[CYCLE_A_PARAM + part].getValue() * 10.0f;
 
-			for (int c = 0; c < channels[part]; c += 4) {
-				riseCV[c / 4] = param_rise;
-				fallCV[c / 4] = param_fall;
-				cycle[c / 4] = param_cycle;
-				in_trig[c / 4] = param_trig;
-			}
-
-			// read inputs:
-			if (inputs[IN_A_INPUT + part].isConnected()) {
-				for (int c = 0; c < channels[part]; c += 4)
-					in[c / 4] = inputs[IN_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
-			}
+			RampShape shape;
+			shape.setShape(params[SHAPE_A_PARAM + part].getValue());
 
-			if (inputs[TRIGG_A_INPUT + part].isConnected()) {
-				for (int c = 0; c < channels[part]; c += 4)
-					in_trig[c / 4] += inputs[TRIGG_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
-			}
+			const bool inConnected = inputs[IN_A_INPUT + part].isConnected();
+			const bool trigConnected = inputs[TRIGG_A_INPUT + part].isConnected();
+			const bool expConnected = inputs[EXP_CV_A_INPUT + part].isConnected();
 
-			if (inputs[EXP_CV_A_INPUT + part].isConnected()) {
-				float_4 expCV[4] = {};
-				for (int c = 0; c < channels[part]; c += 4)
-					expCV[c / 4] = inputs[EXP_CV_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
+			// single pass per SIMD group: read inputs, then process
+			for (int c = 0; c < channels[part]; c += 4) {
 
-				for (int c = 0; c < channels[part]; c += 4) {
-					riseCV[c / 4] -= expCV[c / 4];
-					fallCV[c / 4] -= expCV[c / 4];
+				// read inputs:
+				float_4 in = inConnected ? inputs[IN_A_INPUT + part].getPolyVoltageSimd<float_4>(c) : float_4::zero();
+				float_4 in_trig = param_trig;
+				if (trigConnected) {
+					in_trig += inputs[TRIGG_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
 				}
-			}
-
-			for (int c = 0; c < channels[part]; c += 4)
-				riseCV[c / 4] += inputs[RISE_CV_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
-			for (int c = 0; c < channels[part]; c += 4)
-				fallCV[c / 4] += inputs[FALL_CV_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
-			for (int c = 0; c < channels[part]; c += 4)
-				cycle[c / 4] += inputs[CYCLE_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
-
-			// start processing:
-			for (int c = 0; c < channels[part]; c += 4) {
+				const float_4 expCV = expConnected ? inputs[EXP_CV_A_INPUT + part].getPolyVoltageSimd<float_4>(c) : float_4::zero();
+				const float_4 riseCV = param_rise - expCV + inputs[RISE_CV_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
+				const float_4 fallCV = param_fall - expCV + inputs[FALL_CV_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
+				const float_4 cycle = param_cycle + inputs[CYCLE_A_INPUT + part].getPolyVoltageSimd<float_4>(c);
 
 				// process SchmittTriggers
-				float_4 trig_mask = trigger_4[part][c / 4].process(in_trig[c / 4] / 2.0, 0.1, 2.0);
+				float_4 crossing;
+				float_4 trig_mask = trigger_4[part][c / 4].process(in_trig, crossing);
+				// a triggered ramp starts from where the trigger crossed the threshold, between samples (not for the button)
+				const float_4 elapsed = param_trig ? 0.f : ifelse(trig_mask, SubSampleTrigger_4::getTimeSinceCrossing(crossing, args.sampleTime), 0.f);
 				gate[part][c / 4] = ifelse(trig_mask, float_4::mask(), gate[part][c / 4]);
-				in[c / 4] = ifelse(gate[part][c / 4], 10.0f, in[c / 4]);
+				in = ifelse(gate[part][c / 4], 10.0f, in);
 
-				float_4 delta = in[c / 4] - out[part][c / 4];
+				float_4 delta = in - out[part][c / 4];
 
 				// rise / fall branching
 				float_4 delta_gt_0 = delta > 0.f;
 				float_4 delta_lt_0 = delta < 0.f;
 				float_4 delta_eq_0 = ~(delta_lt_0 | delta_gt_0);
 
-				float_4 rateCV = ifelse(delta_gt_0, riseCV[c / 4], 0.f);
-				rateCV = ifelse(delta_lt_0, fallCV[c / 4], rateCV);
+				float_4 rateCV = ifelse(delta_gt_0, riseCV, 0.f);
+				rateCV = ifelse(delta_lt_0, fallCV, rateCV);
 				rateCV = clamp(rateCV, 0.f, 10.0f);
 
-				float_4 rate = minTime * simd::pow(2.0f, rateCV);
-
-				float shape = params[SHAPE_A_PARAM + part].getValue();
-				out[part][c / 4] += shapeDelta(delta, rate, shape) * args.sampleTime;
+				// rate = minTime * 2^rateCV (rateCV >= 0, where exp2_taylor5 is accurate)
+				const float_4 rateInv = 1.f / (minTime * dsp::exp2_taylor5(rateCV));
+				out[part][c / 4] += shape.process(delta, rateInv) * (args.sampleTime + elapsed);
 
-				float_4 rising  = simd::ifelse(delta_gt_0, (in[c / 4] - out[part][c / 4]) > 1e-3f, float_4::zero());
-				float_4 falling = simd::ifelse(delta_lt_0, (in[c / 4] - out[part][c / 4]) < -1e-3f, float_4::zero());
+				float_4 rising  = simd::ifelse(delta_gt_0, (in - out[part][c / 4]) > 1e-3f, float_4::zero());
+				float_4 falling = simd::ifelse(delta_lt_0, (in - out[part][c / 4]) < -1e-3f, float_4::zero());
 
 				float_4 end_of_cycle = simd::andnot(falling, delta_lt_0);
 
 				endOfCyclePulse[part][c / 4].trigger(end_of_cycle, 1e-3);
 
 				gate[part][c / 4] = ifelse(simd::andnot(rising, delta_gt_0), 0.f, gate[part][c / 4]);
-				gate[part][c / 4] = ifelse(end_of_cycle & (cycle[c / 4] >= 4.0f), float_4::mask(), gate[part][c / 4]);
+				gate[part][c / 4] = ifelse(end_of_cycle & (cycle >= 4.0f), float_4::mask(), gate[part][c / 4]);
 				gate[part][c / 4] = ifelse(delta_eq_0, 0.f, gate[part][c / 4]);
 
-				out[part][c / 4]  = ifelse(rising | falling, out[part][c / 4], in[c / 4]);
+				out[part][c / 4]  = ifelse(rising | falling, out[part][c / 4], in);
 
 				float_4 out_rising  = ifelse(rising, 10.0f, 0.f);
 				float_4 out_falling = ifelse(falling, 10.0f, 0.f);
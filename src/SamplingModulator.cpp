@@ -53,8 +53,10 @@ struct SamplingModulator : Module {
 	dsp::MinBlepGenerator<16, 32> holdMinBlep;
 	bool removeDC = true;
 
-	float stepPhase = 0.f;
+	// phase of the internal clock, in 32-bit fixed point (a full cycle is 2^32) so it wraps exactly and can't drift
+	uint32_t stepPhase = 0;
 	float heldValue = 0.f;
+	static constexpr uint32_t halfCycle = 1u << 31;
 	/** Whether we are past the pulse width already */
 	bool halfPhase = false;
 
@@ -84,7 +86,7 @@ struct SamplingModulator : Module {
 			// if internal mode, the SYNC/EXT. CLOCK input acts as oscillator sync, resetting the phase
 			if (clock.process(rescale(inputs[SYNC_INPUT].getVoltage(), 0.1f, 2.f, 0.f, 1.f))) {
 				advanceStep = true;
-				stepPhase = 0.f;
+				stepPhase = 0;
 				halfPhase = false;
 			}
 		}
@@ -110,15 +112,19 @@ struct SamplingModulator : Module {
 
 		const float pitch = 16.f * params[RATE_PARAM].getValue() + params[FINE_PARAM].getValue() + inputs[VOCT_INPUT].getVoltage();
 		const float minDialFrequency = 1.0f;
-		const float frequency = minDialFrequency * simd::pow(2.f, pitch);
+		const float frequency = minDialFrequency * exp2_taylor5_bipolar(pitch);
 
-		const float oldPhase = stepPhase;
-		float deltaPhase = clamp(args.sampleTime * frequency, 1e-6f, 0.5f);
-		stepPhase += deltaPhase;
+		const float deltaPhase = clamp(args.sampleTime * frequency, 1e-6f, 0.5f);
+		const uint32_t deltaPhaseFixed = deltaPhase * 4294967296.f;
+		const uint32_t oldPhase = stepPhase;
+		stepPhase += deltaPhaseFixed;
+		// as deltaPhase <= 0.5, the phase wraps at most once per sample
+		const bool wrapped = stepPhase < oldPhase;
 
-		if (!halfPhase && stepPhase >= 0.5) {
+		if (!halfPhase && (stepPhase >= halfCycle || wrapped)) {
 
-			float crossing  = -(stepPhase - 0.5) / deltaPhase;
+			// how far past the half cycle we are (modulo 2^32, so also valid if we have wrapped)
+			float crossing  = -(float)(stepPhase - halfCycle) / deltaPhaseFixed;
 			if (isClockOutRequired) {
 				squareMinBlep.insertDiscontinuity(crossing, -2.f);
 			}
@@ -129,11 +135,10 @@ struct SamplingModulator : Module {
 			halfPhase = true;
 		}
 
-		if (stepPhase >= 1.0f) {
-			stepPhase -= 1.0f;
+		if (wrapped) {
 
 			if (isClockOutRequired) {
-				float crossing = -stepPhase / deltaPhase;
+				float crossing = -(float) stepPhase / deltaPhaseFixed;
 				squareMinBlep.insertDiscontinuity(crossing, +2.f);
 			}
 
@@ -148,7 +153,8 @@ struct SamplingModulator : Module {
 			currentStep = (currentStep + 1) % std::max(1, numEffectiveSteps);
 
 			if (stepStates[currentStep] == STATE_ON) {
-				const float crossing = -(oldPhase + deltaPhase - 1.0) / deltaPhase;
+				// i.e. -(oldPhase + deltaPhase - 1) / deltaPhase, in fixed point
+				const float crossing = -((float) stepPhase / 4294967296.f - !wrapped) / deltaPhase;
 				triggMinBlep.insertDiscontinuity(crossing, +2.f);
 				triggerGenerator.trigger();
 
@@ -164,7 +170,7 @@ struct SamplingModulator : Module {
 		outputs[OUT_OUTPUT].setVoltage(holdOutput);
 
 		if (isClockOutRequired) {
-			float square = (stepPhase < 0.5) ? 2.f : 0.f;
+			float square = (stepPhase < halfCycle) ? 2.f : 0.f;
 			square += squareMinBlep.process();
 			square -= 1.0f * removeDC;
 			outputs[CLOCK_OUTPUT].setVoltage(5.f * square);
@@ -175,7 +181,7 @@ struct SamplingModulator : Module {
 
 		if (params[INT_EXT_PARAM].getValue() == CLOCK_INTERNAL) {
 			if (isTriggOutRequired) {
-				float trigger = (stepPhase < 0.5 && stepStates[currentStep] == STATE_ON) ? 2.f : 0.f;
+				float trigger = (stepPhase < halfCycle && stepStates[currentStep] == STATE_ON) ? 2.f : 0.f;
 				trigger += triggMinBlep.process();
 
 				if (removeDC) {
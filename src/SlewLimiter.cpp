@@ -22,6 +22,27 @@ struct SlewLimiter : Module {
 
 	float_4 out[4] = {};
 
+	// slopes in volts per second, for rising and falling
+	ControlRateRamp<float_4> riseSlew[4];
+	ControlRateRamp<float_4> fallSlew[4];
+	// exact exponential mode only: 1 - exp(-slew * shapeScale * dt), the fraction of the remaining distance that an
+	// exponential (one-pole) slew covers in one sample
+	ControlRateRamp<float_4> riseDecay[4];
+	ControlRateRamp<float_4> fallDecay[4];
+
+	// slew rates only change with params and CV, so are recomputed every 16 samples (and interpolated in between)
+	ControlRateDivider cvDivider;
+
+	// the exponential part of the shape is integrated exactly (using the per sample decay), rather than with a forward Euler
+	// step, which overshoots (and so is clamped) for fast slews
+	bool exactExponential = false;
+
+	// minimum and std::maximum slopes in volts per second
+	static constexpr float slewMin = 0.1;
+	static constexpr float slewMax = 10000.f;
+	// Amount of extra slew per voltage difference
+	static constexpr float shapeScale = 1 / 10.f;
+
 	SlewLimiter() {
 		config(NUM_PARAMS, NUM_INPUTS, NUM_OUTPUTS);
 		configParam(SHAPE_PARAM, 0.0, 1.0, 0.0, "Shape");
@@ -33,57 +54,95 @@ struct SlewLimiter : Module {
 		configInput(FALL_INPUT, "Fall CV");
 	}
 
-	void process(const ProcessArgs& args) override {
+	void onSampleRateChange() override {
+		// the exact decay depends on the sample time, so don't interpolate from the old one
+		cvDivider.reset();
+	}
 
-		float_4 in[4] = {};
-		float_4 riseCV[4] = {};
-		float_4 fallCV[4] = {};
+	// given the rise or fall CV (param + input, 0 to 10V), the slope in volts per second
+	static float_4 slewFromCV(float_4 rateCV) {
+		return slewMax * simd::pow(slewMin / slewMax, rateCV * 0.1f);
+	}
+
+	void updateSlews(int c, float sampleTime) {
+		const float_4 param_rise = params[RISE_PARAM].getValue() * 10.f;
+		const float_4 param_fall = params[FALL_PARAM].getValue() * 10.f;
+
+		float_4 riseCV = param_rise;
+		float_4 fallCV = param_fall;
+		if (inputs[RISE_INPUT].isConnected()) {
+			riseCV += inputs[RISE_INPUT].getPolyVoltageSimd<float_4>(c);
+		}
+		if (inputs[FALL_INPUT].isConnected()) {
+			fallCV += inputs[FALL_INPUT].getPolyVoltageSimd<float_4>(c);
+		}
+
+		const float_4 rise = slewFromCV(riseCV);
+		const float_4 fall = slewFromCV(fallCV);
+		const float_4 riseDecayTarget = 1.f - simd::exp(-rise * shapeScale * sampleTime);
+		const float_4 fallDecayTarget = 1.f - simd::exp(-fall * shapeScale * sampleTime);
+
+		cvDivider.setTarget(riseSlew[c / 4], rise);
+		cvDivider.setTarget(fallSlew[c / 4], fall);
+		cvDivider.setTarget(riseDecay[c / 4], riseDecayTarget);
+		cvDivider.setTarget(fallDecay[c / 4], fallDecayTarget);
+	}
+
+	void process(const ProcessArgs& args) override {
 
 		// this is the number of active polyphony engines, defined by the input
 		int numPolyphonyEngines = inputs[IN_INPUT].getChannels();
 
-		// minimum and std::maximum slopes in volts per second
-		const float slewMin = 0.1;
-		const float slewMax = 10000.f;
-		// Amount of extra slew per voltage difference
-		const float shapeScale = 1 / 10.f;
-
-		const float_4 param_rise = params[RISE_PARAM].getValue() * 10.f;
-		const float_4 param_fall = params[FALL_PARAM].getValue() * 10.f;
+		const float shape = params[SHAPE_PARAM].getValue();
 
 		outputs[OUT_OUTPUT].setChannels(numPolyphonyEngines);
 
-		for (int c = 0; c < numPolyphonyEngines; c += 4) {
-			in[c / 4] = inputs[IN_INPUT].getVoltageSimd<float_4>(c);
+		const bool updateCV = cvDivider.process();
 
-			if (inputs[RISE_INPUT].isConnected()) {
-				riseCV[c / 4] = inputs[RISE_INPUT].getPolyVoltageSimd<float_4>(c);
-			}
-			if (inputs[FALL_INPUT].isConnected()) {
-				fallCV[c / 4] = inputs[FALL_INPUT].getPolyVoltageSimd<float_4>(c);
+		for (int c = 0; c < numPolyphonyEngines; c += 4) {
+			if (updateCV) {
+				updateSlews(c, args.sampleTime);
 			}
 
-			riseCV[c / 4] += param_rise;
-			fallCV[c / 4] += param_fall;
+			const float_4 in = inputs[IN_INPUT].getVoltageSimd<float_4>(c);
 
-			float_4 delta = in[c / 4] - out[c / 4];
+			float_4 delta = in - out[c / 4];
 			float_4 delta_gt_0 = delta > 0.f;
 			float_4 delta_lt_0 = delta < 0.f;
 
-			float_4 rateCV = {};
-			rateCV = ifelse(delta_gt_0, riseCV[c / 4], 0.f);
-			rateCV = ifelse(delta_lt_0, fallCV[c / 4], rateCV) * 0.1f;
-
 			float_4 pm_one = simd::sgn(delta);
-			float_4 slew = slewMax * simd::pow(slewMin / slewMax, rateCV);
+			float_4 slew = ifelse(delta_gt_0, riseSlew[c / 4].process(), fallSlew[c / 4].process());
 
-			const float shape = params[SHAPE_PARAM].getValue();
-			out[c / 4] += slew * simd::crossfade(pm_one, shapeScale * delta, shape) * args.sampleTime;
-			out[c / 4] = ifelse(delta_gt_0 & (out[c / 4] > in[c / 4]), in[c / 4], out[c / 4]);
-			out[c / 4] = ifelse(delta_lt_0 & (out[c / 4] < in[c / 4]), in[c / 4], out[c / 4]);
+			if (exactExponential) {
+				const float_4 decay = ifelse(delta_gt_0, riseDecay[c / 4].process(), fallDecay[c / 4].process());
+				out[c / 4] += (1.f - shape) * slew * pm_one * args.sampleTime + shape * decay * delta;
+			}
+			else {
+				out[c / 4] += slew * simd::crossfade(pm_one, shapeScale * delta, shape) * args.sampleTime;
+			}
+			out[c / 4] = ifelse(delta_gt_0 & (out[c / 4] > in), in, out[c / 4]);
+			out[c / 4] = ifelse(delta_lt_0 & (out[c / 4] < in), in, out[c / 4]);
 
 			outputs[OUT_OUTPUT].setVoltageSimd(out[c / 4], c);
 		}
+
+		// nothing was updated, so keep the first update (which jumps rather than ramps) pending
+		if (updateCV && numPolyphonyEngines == 0) {
+			cvDivider.reset();
+		}
+	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "exactExponential", json_boolean(exactExponential));
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* exactExponentialJ = json_object_get(rootJ, "exactExponential");
+		if (exactExponentialJ) {
+			exactExponential = json_boolean_value(exactExponentialJ);
+		}
 	}
 };
 
@@ -107,6 +166,14 @@ struct SlewLimiterWidget : ModuleWidget {
 		addInput(createInput<BefacoInputPort>(Vec(10, 323), module, ::SlewLimiter::IN_INPUT));
 		addOutput(createOutput<BefacoOutputPort>(Vec(55, 323), module, ::SlewLimiter::OUT_OUTPUT));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		::SlewLimiter* module = dynamic_cast<::SlewLimiter*>(this->module);
+		assert(module);
+
+		menu->addChild(new MenuSeparator());
+		menu->addChild(createBoolPtrMenuItem("Exact exponential slew", "", &module->exactExponential));
+	}
 };
 
 
@@ -1,22 +1,72 @@
 #include "plugin.hpp"
-#include <pffft.h>
+#include "PartitionedConvolver.hpp"
+#include <map>
+#include <mutex>
 
-static std::vector<uint8_t> ir;
+// the IR asset is recorded at 48 kHz
+static const int IR_SAMPLE_RATE = 48000;
+
+static std::vector<float> ir;
+
+// IR spectra keyed by sample rate, shared by all instances running at that rate and freed with the last of them
+static std::map<int, std::weak_ptr<const PartitionedKernel>> kernelCache;
+static std::mutex kernelCacheMutex;
 
 static void initIR() {
 	if (!ir.empty())
 		return;
 
 	try {
-		ir = system::readFile(asset::plugin(pluginInstance, "res/SpringReverbIR.f32"));
+		std::vector<uint8_t> bytes = system::readFile(asset::plugin(pluginInstance, "res/SpringReverbIR.f32"));
+		const float* kernel = (const float*) bytes.data();
+		ir.assign(kernel, kernel + bytes.size() / sizeof(float));
 	}
 	catch (std::exception& e) {
 		WARN("Cannot load IR: %s", e.what());
 	}
 }
 
-static const size_t BLOCK_SIZE = 1024;
+// resample the 48 kHz IR to the given rate
+static std::vector<float> resampleIR(int sampleRate) {
+	if (sampleRate == IR_SAMPLE_RATE || ir.empty())
+		return ir;
+
+	// pad with zeros so the resampler's filter delay is flushed out along with the tail
+	std::vector<float> padded(ir);
+	padded.resize(ir.size() + 1024, 0.f);
+	std::vector<float> kernel((size_t) padded.size() * sampleRate / IR_SAMPLE_RATE + 1);
+
+	dsp::SampleRateConverter<1> src;
+	src.setQuality(10);
+	src.setRates(IR_SAMPLE_RATE, sampleRate);
+	int inLen = padded.size();
+	int outLen = kernel.size();
+	src.process((const dsp::Frame<1>*) padded.data(), &inLen, (dsp::Frame<1>*) kernel.data(), &outLen);
+	kernel.resize(outLen);
+
+	// more taps at higher rates, so scale to keep the same wet level as convolving at 48 kHz
+	const float gain = (float) IR_SAMPLE_RATE / sampleRate;
+	for (float& x : kernel) {
+		x *= gain;
+	}
+
+	return kernel;
+}
+
+static std::shared_ptr<const PartitionedKernel> getKernel(int sampleRate) {
+	std::lock_guard<std::mutex> lock(kernelCacheMutex);
 
+	std::shared_ptr<const PartitionedKernel> kernel = kernelCache[sampleRate].lock();
+	if (kernel)
+		return kernel;
+
+	initIR();
+	std::vector<float> resampled = resampleIR(sampleRate);
+	kernel = std::make_shared<const PartitionedKernel>(resampled.data(), resampled.size());
+	kernelCache[sampleRate] = kernel;
+
+	return kernel;
+}
 
 struct SpringReverb : Module {
 	enum ParamIds {
@@ -45,13 +95,19 @@ struct SpringReverb : Module {
 		NUM_LIGHTS
 	};
 
-	dsp::RealTimeConvolver* convolver = NULL;
-	dsp::SampleRateConverter<1> inputSrc;
-	dsp::SampleRateConverter<1> outputSrc;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 16 * BLOCK_SIZE> inputBuffer;
-	dsp::DoubleRingBuffer<dsp::Frame<1>, 16 * BLOCK_SIZE> outputBuffer;
+	enum InputMode {
+		MONO_SUM,
+		STEREO,
+		POLYPHONIC
+	};
+	InputMode inputMode = MONO_SUM;
+
+	static const int MAX_CHANNELS = PartitionedConvolver::MAX_CHANNELS;
+
+	// runs at the engine sample rate, with the IR resampled to match, all channels share the same IR spectra
+	PartitionedConvolver convolver;
 
-	dsp::RCFilter dryFilter;
+	dsp::RCFilter dryFilter[MAX_CHANNELS];
 
 	dsp::VuMeter2 vuFilter;
 	dsp::VuMeter2 lightFilter;
@@ -66,13 +122,7 @@ struct SpringReverb : Module {
 		configParam(LEVEL2_PARAM, 0.0, 1.0, 0.0, "In 2 level", "%", 0, 100);
 		configParam(HPF_PARAM, 0.0, 1.0, 0.5, "High pass filter cutoff");
 
-		initIR();
-
-		convolver = new dsp::RealTimeConvolver(BLOCK_SIZE);
-
-		const float* kernel = (const float*) ir.data();
-		size_t kernelLen = ir.size() / sizeof(float);
-		convolver->setKernel(kernel, kernelLen);
+		onSampleRateChange();
 
 		vuFilter.mode = dsp::VuMeter2::PEAK;
 		lightFilter.mode = dsp::VuMeter2::PEAK;
@@ -80,82 +130,128 @@ struct SpringReverb : Module {
 		lightRefreshClock.setDivision(32);
 	}
 
-	~SpringReverb() {
-		delete convolver;
+	void onSampleRateChange() override {
+		const int sampleRate = (int) std::round(APP->engine->getSampleRate());
+		convolver.setKernel(getKernel(sampleRate), getNumChannels());
+		convolver.reserveChannels(getMaxChannels(inputMode));
+	}
+
+	// channels the convolver must have allocated for a mode, polyphony can change at any time so allow for the maximum
+	static int getMaxChannels(InputMode mode) {
+		switch (mode) {
+			case STEREO: return 2;
+			case POLYPHONIC: return MAX_CHANNELS;
+			default: return 1;
+		}
+	}
+
+	// allocates the convolver channels the new mode needs (outside the audio thread) before switching to it
+	void setInputMode(InputMode newMode) {
+		convolver.reserveChannels(getMaxChannels(newMode));
+		inputMode = newMode;
+	}
+
+	int getNumChannels() {
+		switch (inputMode) {
+			case STEREO: return 2;
+			case POLYPHONIC: return std::max({1, inputs[IN1_INPUT].getChannels(), inputs[IN2_INPUT].getChannels()});
+			default: return 1;
+		}
+	}
+
+	// per channel signals for In 1 and In 2, according to the input mode
+	void getInputs(int c, float& in1, float& in2) {
+		switch (inputMode) {
+			case STEREO: {
+				in1 = (c == 0) ? inputs[IN1_INPUT].getVoltageSum() : 0.f;
+				in2 = (c == 1) ? inputs[IN2_INPUT].getVoltageSum() : 0.f;
+				break;
+			}
+			case POLYPHONIC: {
+				in1 = inputs[IN1_INPUT].getPolyVoltage(c);
+				in2 = inputs[IN2_INPUT].getPolyVoltage(c);
+				break;
+			}
+			default: {
+				in1 = inputs[IN1_INPUT].getVoltageSum();
+				in2 = inputs[IN2_INPUT].getVoltageSum();
+			}
+		}
 	}
 
 	void processBypass(const ProcessArgs& args) override {
-		float in1 = inputs[IN1_INPUT].getVoltageSum();
-		float in2 = inputs[IN2_INPUT].getVoltageSum();
+		const int numChannels = getNumChannels();
+
+		for (int c = 0; c < numChannels; c++) {
+			float in1, in2;
+			getInputs(c, in1, in2);
+
+			float dry = clamp(in1 + in2, -10.0f, 10.0f);
 
-		float dry = clamp(in1 + in2, -10.0f, 10.0f);
+			outputs[WET_OUTPUT].setVoltage(dry, c);
+			outputs[MIX_OUTPUT].setVoltage(dry, c);
+		}
 
-		outputs[WET_OUTPUT].setVoltage(dry);
-		outputs[MIX_OUTPUT].setVoltage(dry);
+		outputs[WET_OUTPUT].setChannels(numChannels);
+		outputs[MIX_OUTPUT].setChannels(numChannels);
 	}
 
 	void process(const ProcessArgs& args) override {
-		float in1 = inputs[IN1_INPUT].getVoltageSum();
-		float in2 = inputs[IN2_INPUT].getVoltageSum();
+		const int numChannels = getNumChannels();
+		// channels were allocated up front for the current mode, so this never allocates
+		convolver.setChannels(numChannels);
+
 		const float levelScale = 0.030;
 		const float levelBase = 25.0;
-		float level1 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL1_PARAM].getValue()) * inputs[CV1_INPUT].getNormalVoltage(10.0) / 10.0;
-		float level2 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL2_PARAM].getValue()) * inputs[CV2_INPUT].getNormalVoltage(10.0) / 10.0;
-		float dry = in1 * level1 + in2 * level2;
-
-		// HPF on dry
-		float dryCutoff = 200.0 * std::pow(20.0, params[HPF_PARAM].getValue()) * args.sampleTime;
-		dryFilter.setCutoff(dryCutoff);
-		dryFilter.process(dry);
-
-		// Add dry to input buffer
-		if (!inputBuffer.full()) {
-			dsp::Frame<1> inputFrame;
-			inputFrame.samples[0] = dryFilter.highpass();
-			inputBuffer.push(inputFrame);
-		}
-
-
-		if (outputBuffer.empty()) {
-			float input[BLOCK_SIZE] = {};
-			float output[BLOCK_SIZE];
-			// Convert input buffer
-			{
-				inputSrc.setRates(args.sampleRate, 48000);
-				int inLen = inputBuffer.size();
-				int outLen = BLOCK_SIZE;
-				inputSrc.process(inputBuffer.startData(), &inLen, (dsp::Frame<1>*) input, &outLen);
-				inputBuffer.startIncr(inLen);
+		const float levelKnob1 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL1_PARAM].getValue());
+		const float levelKnob2 = levelScale * dsp::exponentialBipolar(levelBase, params[LEVEL2_PARAM].getValue());
+		const float dryCutoff = 200.0 * std::pow(20.0, params[HPF_PARAM].getValue()) * args.sampleTime;
+		const float balance = clamp(params[WET_PARAM].getValue() + inputs[MIX_CV_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
+
+		float in1[MAX_CHANNELS];
+		float dry[MAX_CHANNELS];
+		float wet[MAX_CHANNELS] = {};
+		float peakDry = 0.f;
+
+		for (int c = 0; c < numChannels; c++) {
+			float in2;
+			getInputs(c, in1[c], in2);
+
+			// in stereo mode each side uses its own input as the unprocessed signal in the mix
+			const float level1 = levelKnob1 * inputs[CV1_INPUT].getNormalPolyVoltage(10.0, c) / 10.0;
+			const float level2 = levelKnob2 * inputs[CV2_INPUT].getNormalPolyVoltage(10.0, c) / 10.0;
+			const float levelled = in1[c] * level1 + in2 * level2;
+			if (inputMode == STEREO && c == 1) {
+				in1[c] = in2;
 			}
 
-			// Convolve block
-			convolver->processBlock(input, output);
+			// HPF on dry
+			dryFilter[c].setCutoff(dryCutoff);
+			dryFilter[c].process(levelled);
+			dry[c] = dryFilter[c].highpass();
 
-			// Convert output buffer
-			{
-				outputSrc.setRates(48000, args.sampleRate);
-				int inLen = BLOCK_SIZE;
-				int outLen = outputBuffer.capacity();
-				outputSrc.process((dsp::Frame<1>*) output, &inLen, outputBuffer.endData(), &outLen);
-				outputBuffer.endIncr(outLen);
-			}
+			peakDry = std::max(peakDry, std::abs(levelled));
 		}
 
-		// Set output
-		if (outputBuffer.empty())
-			return;
+		// Convolve all channels together (work for the longer partitions is spread across samples)
+		convolver.process(dry, wet);
 
-		float wet = outputBuffer.shift().samples[0];
-		float balance = clamp(params[WET_PARAM].getValue() + inputs[MIX_CV_INPUT].getVoltage() / 10.0f, 0.0f, 1.0f);
-		float mix = crossfade(in1, wet, balance);
+		float peakWet = 0.f;
+		for (int c = 0; c < numChannels; c++) {
+			float mix = crossfade(in1[c], wet[c], balance);
 
-		outputs[WET_OUTPUT].setVoltage(clamp(wet, -10.0f, 10.0f));
-		outputs[MIX_OUTPUT].setVoltage(clamp(mix, -10.0f, 10.0f));
+			outputs[WET_OUTPUT].setVoltage(clamp(wet[c], -10.0f, 10.0f), c);
+			outputs[MIX_OUTPUT].setVoltage(clamp(mix, -10.0f, 10.0f), c);
+
+			peakWet = std::max(peakWet, std::abs(wet[c]));
+		}
+		outputs[WET_OUTPUT].setChannels(numChannels);
+		outputs[MIX_OUTPUT].setChannels(numChannels);
 
 		// process VU lights
-		vuFilter.process(args.sampleTime, wet);
+		vuFilter.process(args.sampleTime, peakWet);
 		// process peak light
-		lightFilter.process(args.sampleTime, dry * 50.0);
+		lightFilter.process(args.sampleTime, peakDry * 50.0);
 
 		if (lightRefreshClock.process()) {
 
@@ -167,6 +263,20 @@ struct SpringReverb : Module {
 			lights[PEAK_LIGHT].value = lightFilter.v;
 		}
 	}
+
+	json_t* dataToJson() override {
+		json_t* rootJ = json_object();
+		json_object_set_new(rootJ, "inputMode", json_integer(inputMode));
+
+		return rootJ;
+	}
+
+	void dataFromJson(json_t* rootJ) override {
+		json_t* inputModeJ = json_object_get(rootJ, "inputMode");
+		if (inputModeJ) {
+			setInputMode((InputMode) json_integer_value(inputModeJ));
+		}
+	}
 };
 
 
@@ -205,6 +315,22 @@ struct SpringReverbWidget : ModuleWidget {
 		addChild(createLight<MediumLight<GreenLight>>(Vec(55, 175), module, SpringReverb::VU1_LIGHTS + 5));
 		addChild(createLight<MediumLight<GreenLight>>(Vec(55, 188), module, SpringReverb::VU1_LIGHTS + 6));
 	}
+
+	void appendContextMenu(Menu* menu) override {
+		SpringReverb* module = dynamic_cast<SpringReverb*>(this->module);
+		assert(module);
+
+		menu->addChild(new MenuSeparator());
+		menu->addChild(createIndexSubmenuItem("Mode",
+		{"Mono (inputs summed)", "Stereo (In 1 left, In 2 right)", "Polyphonic"},
+		[ = ]() {
+			return module->inputMode;
+		},
+		[ = ](int mode) {
+			module->setInputMode((SpringReverb::InputMode) mode);
+		}
+		                                     ));
+	}
 };
 
 
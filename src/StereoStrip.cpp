@@ -15,29 +15,15 @@ enum AeEQType {
 	AePEAKINGEQ
 };
 
-template <typename T>
-struct AeFilter {
-	T x[2] = {};
-	T y[2] = {};
-
-	float a0, a1, a2, b0, b1, b2;
-
-	inline T process(const T& in) noexcept {
-		T out = b0 * in + b1 * x[0] + b2 * x[1] - a1 * y[0] - a2 * y[1];
-
-		//shift buffers
-		x[1] = x[0];
-		x[0] = in;
-		y[1] = y[0];
-		y[0] = out;
-
-		return out;
-	}
+// biquad coefficients, normalised so that a0 = 1
+struct AeCoefficients {
+	float b0 = 1.f, b1 = 0.f, b2 = 0.f, a1 = 0.f, a2 = 0.f;
 
 	void setCutoff(float f, float q, int type) {
 		const float w0 = 2 * M_PI * f / APP->engine->getSampleRate();
 		const float alpha = std::sin(w0) / (2.0f * q);
 		const float cs0 = std::cos(w0);
+		float a0;
 
 		switch (type) {
 			case AeLOWPASS:
@@ -57,51 +43,6 @@ struct AeFilter {
 				a2 = (1 - alpha) / a0;
 		}
 	}
-};
-
-template <typename T>
-struct AeFilterStereo : AeFilter<T> {
-	T xl[2] = {};
-	T xr[2] = {};
-	T yl[2] = {};
-	T yr[2] = {};
-
-	void process(T* inL, T* inR) {
-		T l = AeFilter<T>::b0 * *inL + AeFilter<T>::b1 * xl[0] + AeFilter<T>::b2 * xl[1] - AeFilter<T>::a1 * yl[0] - AeFilter<T>::a2 * yl[1];
-		T r = AeFilter<T>::b0 * *inR + AeFilter<T>::b1 * xr[0] + AeFilter<T>::b2 * xr[1] - AeFilter<T>::a1 * yr[0] - AeFilter<T>::a2 * yr[1];
-
-		//shift buffers
-		xl[1] = xl[0];
-		xl[0] = *inL;
-		xr[1] = xr[0];
-		xr[0] = *inR;
-
-		yl[1] = yl[0];
-		yl[0] = l;
-		yr[1] = yr[0];
-		yr[0] = r;
-
-		*inL = l;
-		*inR = r;
-	}
-};
-
-template <typename T>
-struct AeEqualizer {
-	T x[2] = {};
-	T y[2] = {};
-
-	float a0, a1, a2, b0, b1, b2;
-
-	T process(T in) {
-		T out = b0 * in + b1 * x[0] + b2 * x[1] - a1 * y[0] - a2 * y[1];
-		//shift buffers
-		x[1] = x[0];
-		x[0] = in;
-		y[1] = y[0];
-		y[0] = out;
-		return out;
-	}
 
 	void setParams(float f, float q, float gaindb, AeEQType type) {
 
@@ -109,6 +50,7 @@ struct AeEqualizer {
 		const float alpha = sin(w0) / (2.0f * q);
 		const float cs0 = cos(w0);
 		const float A = pow(10, gaindb / 40.0f);
+		float a0;
 
 		switch (type) {
 			case AeLOWSHELVE:
@@ -138,30 +80,49 @@ struct AeEqualizer {
 	}
 };
 
-template <typename T>
-struct AeEqualizerStereo : AeEqualizer<T> {
-	T xl[2] = {};
-	T xr[2] = {};
-	T yl[2] = {};
-	T yr[2] = {};
-
-	void process(T* inL, T* inR) {
-		T l = AeEqualizer<T>::b0 * *inL + AeEqualizer<T>::b1 * xl[0] + AeEqualizer<T>::b2 * xl[1] - AeEqualizer<T>::a1 * yl[0] - AeEqualizer<T>::a2 * yl[1];
-		T r = AeEqualizer<T>::b0 * *inR + AeEqualizer<T>::b1 * xr[0] + AeEqualizer<T>::b2 * xr[1] - AeEqualizer<T>::a1 * yr[0] - AeEqualizer<T>::a2 * yr[1];
-
-		// shift buffers
-		xl[1] = xl[0];
-		xl[0] = *inL;
-		xr[1] = xr[0];
-		xr[0] = *inR;
-
-		yl[1] = yl[0];
-		yl[0] = l;
-		yr[1] = yr[0];
-		yr[0] = r;
-
-		*inL = l;
-		*inR = r;
+// The StereoStrip filter chain (low, mid and high EQ, then the optional highpass and high shelf) for up to 16 voices of
+// stereo audio. Each band has a single set of coefficients, shared by every voice and both sides, and the filter state
+// keeps left and right adjacent, so the whole chain runs as one per-sample kernel over contiguous memory.
+struct StereoStripFilterChain {
+	enum Band {
+		LOW_BAND,
+		MID_BAND,
+		HIGH_BAND,
+		HIGHPASS_BAND,
+		HIGHSHELF_BAND,
+		NUM_BANDS
+	};
+
+	AeCoefficients coefficients[NUM_BANDS];
+
+	// direct form I state of a band, for one group of 4 voices: each of x[n-1], x[n-2], y[n-1], y[n-2] as {left, right}
+	struct BandState {
+		float_4 x1[2] = {}, x2[2] = {};
+		float_4 y1[2] = {}, y2[2] = {};
+	};
+	BandState state[4][NUM_BANDS];
+
+	// filters (in place) the left and right signals of voice group g
+	void process(int g, float_4* io, bool applyHighpass, bool applyHighshelf) {
+		for (int band = 0; band < NUM_BANDS; ++band) {
+			if ((band == HIGHPASS_BAND && !applyHighpass) || (band == HIGHSHELF_BAND && !applyHighshelf)) {
+				continue;
+			}
+
+			const AeCoefficients& k = coefficients[band];
+			BandState& s = state[g][band];
+			for (int side = 0; side < 2; ++side) {
+				const float_4 out = k.b0 * io[side] + k.b1 * s.x1[side] + k.b2 * s.x2[side] - k.a1 * s.y1[side] - k.a2 * s.y2[side];
+
+				// shift buffers
+				s.x2[side] = s.x1[side];
+				s.x1[side] = io[side];
+				s.y2[side] = s.y1[side];
+				s.y1[side] = out;
+
+				io[side] = out;
+			}
+		}
 	}
 };
 
@@ -212,14 +173,10 @@ struct StereoStrip : Module {
 
 	PanningLaw panningLaw = LINEAR_6dB;
 
-	AeEqualizer<float_4> eqLow[4][2];
-	AeEqualizer<float_4> eqMid[4][2];
-	AeEqualizer<float_4> eqHigh[4][2];
+	StereoStripFilterChain filters;
 
 	bool applyHighpass = true;
-	AeFilter<float_4> highpass[4][2];
 	bool applyHighshelf = true;
-	AeEqualizer<float_4> highshelf[4][2];
 	bool applySoftClipping = true;
 
 	float lastLowGain = -INFINITY;
@@ -229,7 +186,10 @@ struct StereoStrip : Module {
 	// for processing mutes
 	dsp::SlewLimiter clickFilter;
 
-	dsp::ClockDivider sliderUpdate;
+	// EQ sliders, level, pan and mute are evaluated once per control block, the resulting per-side gains are then
+	// ramped linearly per sample
+	ControlRateDivider controlRate{16};
+	ControlRateRamp<float_4> gainForSide[4][2];
 
 	StereoStrip() {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
@@ -261,21 +221,16 @@ struct StereoStrip : Module {
 
 		clickFilter.rise = 50.f; // Hz
 		clickFilter.fall = 50.f; // Hz
-
-		// only poll EQ sliders every 16 samples
-		sliderUpdate.setDivision(16);
 	}
 
 	void onSampleRateChange() override {
+		controlRate.reset();
+
 		bool forceUpdate = true;
 		updateEQsIfChanged(forceUpdate);
 
-		for (int side = 0; side < 2; ++side) {
-			for (int c = 0; c < 16; c += 4) {
-				highpass[side][c / 4].setCutoff(25.0f, 0.8f, AeFilterType::AeHIGHPASS);
-				highshelf[side][c / 4].setParams(12000.0f, 0.8f, -5.0f, AeEQType::AeHIGHSHELVE);
-			}
-		}
+		filters.coefficients[StereoStripFilterChain::HIGHPASS_BAND].setCutoff(25.0f, 0.8f, AeFilterType::AeHIGHPASS);
+		filters.coefficients[StereoStripFilterChain::HIGHSHELF_BAND].setParams(12000.0f, 0.8f, -5.0f, AeEQType::AeHIGHSHELVE);
 	}
 
 	void updateEQsIfChanged(bool forceUpdate = false) {
@@ -285,30 +240,59 @@ struct StereoStrip : Module {
 
 		// only calculate coefficients when neccessary
 		if (highGain != lastHighGain || forceUpdate) {
-			for (int c = 0; c < 16; c += 4) {
-				for (int side = 0; side < 2; ++side) {
-					eqHigh[c / 4][side].setParams(2000.0f, 0.4f, highGain, AeEQType::AeHIGHSHELVE);
-				}
-			}
+			filters.coefficients[StereoStripFilterChain::HIGH_BAND].setParams(2000.0f, 0.4f, highGain, AeEQType::AeHIGHSHELVE);
 			lastHighGain = highGain;
 		}
 
 		if (midGain != lastMidGain || forceUpdate) {
-			for (int c = 0; c < 16; c += 4) {
-				for (int side = 0; side < 2; ++side) {
-					eqMid[c / 4][side].setParams(1200.0f, 0.52f, midGain, AeEQType::AePEAKINGEQ);
-				}
-			}
+			filters.coefficients[StereoStripFilterChain::MID_BAND].setParams(1200.0f, 0.52f, midGain, AeEQType::AePEAKINGEQ);
 			lastMidGain = midGain;
 		}
 
 		if (lowGain != lastLowGain || forceUpdate) {
-			for (int c = 0; c < 16; c += 4) {
-				for (int side = 0; side < 2; ++side) {
-					eqLow[c / 4][side].setParams(125.0f, 0.45f, lowGain, AeEQType::AeLOWSHELVE);
+			filters.coefficients[StereoStripFilterChain::LOW_BAND].setParams(125.0f, 0.45f, lowGain, AeEQType::AeLOWSHELVE);
+			lastLowGain = lowGain;
+		}
+	}
+
+	// computes the per-side gains (level, boost/cut, mute and pan law) for the next control block; all groups are
+	// updated so that voices added by a polyphony change mid-block ramp from valid values. The VCA CV is applied per
+	// sample in process(), while pan CV is deliberately decimated to control rate (ramped, so it doesn't zipper)
+	void updateGains(float blockTime) {
+		// slew mute to avoid clicks
+		const float muteGain = clickFilter.process(blockTime, params[MUTE_PARAM].getValue() != MUTE_ON);
+
+		const float switchGains = (params[IN_BOOST_PARAM].getValue() ? 2.0f : 1.0f) * (params[OUT_CUT_PARAM].getValue() ? 0.5f : 1.0f);
+		const float preVCAGain = switchGains * muteGain * std::pow(10, params[LEVEL_PARAM].getValue() / 20.0f);
+
+		for (int c = 0; c < 16; c += 4) {
+
+			const float_4 panCV = clamp(params[PAN_CV_PARAM].getValue() * inputs[PAN_INPUT].getPolyVoltageSimd<float_4>(c) / 5.f, -1.f, +1.f);
+			const float_4 pan = clamp(params[PAN_PARAM].getValue() + panCV, -1.f, +1.f);
+
+			// https://www.desmos.com/calculator/b0lisclikw
+			float_4 gains[2] = {};
+			switch (panningLaw) {
+				case LINEAR_6dB: {
+					gains[LEFT] = preVCAGain * (1.f - pan);
+					gains[RIGHT] = preVCAGain * (1.f + pan);
+					break;
+				}
+				case EQUAL_POWER: {
+					gains[LEFT] = preVCAGain * simd::sqrt(1.f - pan);
+					gains[RIGHT] = preVCAGain * simd::sqrt(1.f + pan);
+					break;
+				}
+				case LINEAR_CLIPPED: {
+					gains[LEFT] = simd::ifelse(pan < 0, preVCAGain, preVCAGain * (1.f - pan));
+					gains[RIGHT] = simd::ifelse(pan > 0, preVCAGain, preVCAGain * (1.f + pan));
+					break;
 				}
 			}
-			lastLowGain = lowGain;
+
+			for (int side = 0; side < 2; ++side) {
+				controlRate.setTarget(gainForSide[c / 4][side], gains[side]);
+			}
 		}
 	}
 
@@ -318,58 +302,26 @@ struct StereoStrip : Module {
 
 		const int numPolyphonyEngines = std::max(inputs[LEFT_INPUT].getChannels(), inputs[RIGHT_INPUT].getChannels());
 
-		// slew mute to avoid clicks
-		const float muteGain = clickFilter.process(args.sampleTime, params[MUTE_PARAM].getValue() != MUTE_ON);
-
 		if (inputs[LEFT_INPUT].isConnected() || inputs[RIGHT_INPUT].isConnected()) {
 
-			const float switchGains = (params[IN_BOOST_PARAM].getValue() ? 2.0f : 1.0f) * (params[OUT_CUT_PARAM].getValue() ? 0.5f : 1.0f);
-			const float preVCAGain = switchGains * muteGain * std::pow(10, params[LEVEL_PARAM].getValue() / 20.0f);
-
-			if (sliderUpdate.process()) {
+			if (controlRate.process()) {
 				updateEQsIfChanged();
+				updateGains(args.sampleTime * controlRate.getDivision());
 			}
 
 			for (int c = 0; c < numPolyphonyEngines; c += 4) {
 
-				const float_4 postVCAGain = preVCAGain * clamp(inputs[LEVEL_INPUT].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.f);
-
-				const float_4 panCV = clamp(params[PAN_CV_PARAM].getValue() * inputs[PAN_INPUT].getPolyVoltageSimd<float_4>(c) / 5.f, -1.f, +1.f);
-				const float_4 pan = clamp(params[PAN_PARAM].getValue() + panCV, -1.f, +1.f);
-
-				// https://www.desmos.com/calculator/b0lisclikw
-				float_4 gainForSide[2] = {};
-				switch (panningLaw) {
-					case LINEAR_6dB: {
-						gainForSide[0] = postVCAGain * (1.f - pan);
-						gainForSide[1] = postVCAGain * (1.f + pan);
-						break;
-					}
-					case EQUAL_POWER: {
-						gainForSide[0] = postVCAGain * simd::sqrt(1.f - pan);
-						gainForSide[1] = postVCAGain * simd::sqrt(1.f + pan);
-						break;
-					}
-					case LINEAR_CLIPPED: {
-						gainForSide[0] = simd::ifelse(pan < 0, postVCAGain, postVCAGain * (1.f - pan));
-						gainForSide[1] = simd::ifelse(pan > 0, postVCAGain, postVCAGain * (1.f + pan));
-						break;
-					}
-				}
-
 				in[c / 4][LEFT] = inputs[LEFT_INPUT].getPolyVoltageSimd<float_4>(c);
 				in[c / 4][RIGHT] = inputs[RIGHT_INPUT].getNormalPolyVoltageSimd<float_4>(in[c / 4][LEFT], c);
 
-				for (int side = 0; side < 2; ++side) {
+				filters.process(c / 4, in[c / 4], applyHighpass, applyHighshelf);
 
-					float_4 outForSide = in[c / 4][side];
+				// VCA CV at audio rate, so that it can be used for amplitude modulation
+				const float_4 vcaGain = clamp(inputs[LEVEL_INPUT].getNormalPolyVoltageSimd<float_4>(10.f, c) / 10.f, 0.f, 1.f);
+
+				for (int side = 0; side < 2; ++side) {
 
-					outForSide = eqLow[c / 4][side].process(outForSide);
-					outForSide = eqMid[c / 4][side].process(outForSide);
-					outForSide = eqHigh[c / 4][side].process(outForSide);
-					outForSide = applyHighpass ? highpass[c / 4][side].process(outForSide) : outForSide;
-					outForSide = applyHighshelf ? highshelf[c / 4][side].process(outForSide) : outForSide;
-					outForSide = outForSide * gainForSide[side];
+					float_4 outForSide = in[c / 4][side] * gainForSide[c / 4][side].process() * vcaGain;
 
 					// soft clipping: the Saturator used elsewhere expects values in range [-1, +1] roughly, so rescale before
 					// and after (assuming input signals are 10Vpp, clipping will kick in above 12Vpp with the present values)
@@ -382,6 +334,11 @@ struct StereoStrip : Module {
 			}
 		}
 
+		else {
+			// nothing to ramp from when an input is (re)connected
+			controlRate.reset();
+		}
+
 		if (numPolyphonyEngines <= 1) {
 			lights[LEFT_LIGHT + 0].setBrightness(0.f);
 			lights[RIGHT_LIGHT + 0].setBrightness(0.f);
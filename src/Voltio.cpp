@@ -23,6 +23,9 @@ struct Voltio : Module {
 		LIGHTS_LEN
 	};
 
+	ControlRateDivider controlRate;
+	ControlRateRamp<float> offset;
+
 	Voltio() {
 		config(PARAMS_LEN, INPUTS_LEN, OUTPUTS_LEN, LIGHTS_LEN);
 		auto octParam = configParam(OCT_PARAM, 0.f, 10.f, 0.f, "Octave");
@@ -39,19 +42,22 @@ struct Voltio : Module {
 	void process(const ProcessArgs& args) override {
 		const int channels = std::max(1, inputs[SUM_INPUT].getChannels());
 
-		for (int c = 0; c < channels; c += 4) {
-			float_4 in = inputs[SUM_INPUT].getPolyVoltageSimd<float_4>(c);
+		// the knobs and switch are only read at control rate, the offset is ramped in between
+		if (controlRate.process()) {
+			const float range = params[RANGE_PARAM].getValue() ? -5.f : 0.f;
+			controlRate.setTarget(offset, params[SEMITONES_PARAM].getValue() / 12.f + params[OCT_PARAM].getValue() + range);
 
-			float offset = params[RANGE_PARAM].getValue() ? -5.f : 0.f;
-			in += params[SEMITONES_PARAM].getValue() / 12.f + params[OCT_PARAM].getValue() + offset;
+			lights[PLUSMINUS5_LIGHT].setBrightness(params[RANGE_PARAM].getValue() ? 1.f : 0.f);
+			lights[ZEROTOTEN_LIGHT].setBrightness(params[RANGE_PARAM].getValue() ? 0.f : 1.f);
+		}
+		const float totalOffset = offset.process();
 
-			outputs[OUT_OUTPUT].setVoltageSimd<float_4>(in, c);
+		for (int c = 0; c < channels; c += 4) {
+			const float_4 in = inputs[SUM_INPUT].getPolyVoltageSimd<float_4>(c);
+			outputs[OUT_OUTPUT].setVoltageSimd<float_4>(in + totalOffset, c);
 		}
 
 		outputs[OUT_OUTPUT].setChannels(channels);
-
-		lights[PLUSMINUS5_LIGHT].setBrightness(params[RANGE_PARAM].getValue() ? 1.f : 0.f);
-		lights[ZEROTOTEN_LIGHT].setBrightness(params[RANGE_PARAM].getValue() ? 0.f : 1.f);
 	}
 
 };
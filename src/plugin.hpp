@@ -267,12 +267,81 @@ T tanh_pade(T x) {
 	return 12.f * x * q / (36.f * x2 + q * q);
 }
 
+// dsp::exp2_taylor5 is only accurate for x >= 0, so offset the argument (as Fundamental VCO does), valid for x > -30
+template <typename T>
+T exp2_taylor5_bipolar(T x) {
+	return dsp::exp2_taylor5(x + 30.f) * (1.f / 1073741824.f);
+}
+
+// adds a discontinuity of size jump, at sub-sample position p, for each of the first numLanes lanes set in mask
+template <int Z, int O>
+void insertMinBlepDiscontinuities(dsp::MinBlepGenerator<Z, O, simd::float_4>& minBlep, simd::float_4 mask, simd::float_4 p,
+                                  simd::float_4 jump, int numLanes) {
+	const int m = simd::movemask(mask) & ((1 << numLanes) - 1);
+	if (!m) {
+		return;
+	}
+	for (int i = 0; i < 4; i++) {
+		if (m & (1 << i)) {
+			simd::float_4 x = simd::float_4::zero();
+			x.s[i] = jump[i];
+			minBlep.insertDiscontinuity(p[i], x);
+		}
+	}
+}
+
 template <typename T>
 T exponentialBipolar80Pade_5_4(T x) {
 	return (T(0.109568) * x + T(0.281588) * simd::pow(x, 3) + T(0.133841) * simd::pow(x, 5))
 	       / (T(1.) - T(0.630374) * simd::pow(x, 2) + T(0.166271) * simd::pow(x, 4));
 }
 
+/** Linearly interpolated lookup table of the envelope curve x^shape for x on [0, 1], rebuilt only when the shape
+changes, so that envelopes don't need std::pow per sample. The table is indexed by sqrt(x), where the curve is u^(2 shape):
+for the concave shapes (down to 0.5) this removes the infinite slope at 0 that linear interpolation handles badly. */
+struct PowerCurveTable {
+	static constexpr int SIZE = 256;
+
+	void setShape(float newShape) {
+		if (newShape == shape) {
+			return;
+		}
+		shape = newShape;
+		for (int i = 0; i <= SIZE; i++) {
+			table[i] = std::pow((float) i / SIZE, 2.f * shape);
+		}
+		// guard point so that x = 1 can be interpolated
+		table[SIZE + 1] = table[SIZE];
+	}
+
+	float getShape() const {
+		return shape;
+	}
+
+	/** x is clamped to [0, 1] */
+	float process(float x) const {
+		const float pos = std::sqrt(clamp(x, 0.f, 1.f)) * SIZE;
+		const int index = (int) pos;
+		return crossfade(table[index], table[index + 1], pos - index);
+	}
+
+	simd::float_4 process(simd::float_4 x) const {
+		const simd::float_4 pos = simd::sqrt(simd::clamp(x, 0.f, 1.f)) * SIZE;
+		const simd::int32_4 index = pos;
+		simd::float_4 a, b;
+		for (int i = 0; i < 4; i++) {
+			a.s[i] = table[index[i]];
+			b.s[i] = table[index[i] + 1];
+		}
+		return simd::crossfade(a, b, pos - simd::float_4(index));
+	}
+
+private:
+	float shape = NAN;
+	float table[SIZE + 2] = {};
+};
+
+/** Attack/decay envelope. Curves are looked up from tables, which are rebuilt when the shapes change. */
 struct ADEnvelope {
 	enum Stage {
 		STAGE_OFF,
@@ -288,17 +357,19 @@ struct ADEnvelope {
 	ADEnvelope() { };
 
 	void process(const float& sampleTime) {
+		attackCurve.setShape(attackShape);
+		decayCurve.setShape(decayShape);
 
 		if (stage == STAGE_OFF) {
 			env = envLinear = 0.0f;
 		}
 		else if (stage == STAGE_ATTACK) {
 			envLinear += sampleTime / attackTime;
-			env = std::pow(envLinear, attackShape);
+			env = attackCurve.process(envLinear);
 		}
 		else if (stage == STAGE_DECAY) {
 			envLinear -= sampleTime / decayTime;
-			env = std::pow(envLinear, decayShape);
+			env = decayCurve.process(envLinear);
 		}
 
 		if (envLinear >= 1.0f) {
@@ -315,11 +386,71 @@ struct ADEnvelope {
 		stage = ADEnvelope::STAGE_ATTACK;
 		// non-linear envelopes won't retrigger at the correct starting point if
 		// attackShape != decayShape, so we advance the linear envelope
-		envLinear = std::pow(env, 1.0f / attackShape);
+		retriggerCurve.setShape(1.0f / attackShape);
+		envLinear = retriggerCurve.process(env);
 	}
 
 private:
 	float envLinear = 0.f;
+	PowerCurveTable attackCurve;
+	PowerCurveTable decayCurve;
+	// inverse of the attack curve
+	PowerCurveTable retriggerCurve;
+};
+
+/** float_4 version of ADEnvelope, where each lane is an independent envelope (with shared shapes). */
+struct ADEnvelope_4 {
+	// per lane stage masks (neither set is STAGE_OFF)
+	simd::float_4 attacking = 0.f;
+	simd::float_4 decaying = 0.f;
+	simd::float_4 env = 0.f;
+	simd::float_4 attackTime = 0.1f, decayTime = 0.1f;
+	float attackShape = 1.0, decayShape = 1.0;
+
+	void process(float sampleTime) {
+		attackCurve.setShape(attackShape);
+		decayCurve.setShape(decayShape);
+
+		envLinear += simd::ifelse(attacking, sampleTime / attackTime, 0.f);
+		envLinear -= simd::ifelse(decaying, sampleTime / decayTime, 0.f);
+		env = simd::ifelse(attacking, attackCurve.process(envLinear), simd::ifelse(decaying, decayCurve.process(envLinear), 0.f));
+
+		const simd::float_4 peaked = envLinear >= 1.f;
+		const simd::float_4 finished = envLinear <= 0.f;
+		attacking = simd::ifelse(peaked | finished, 0.f, attacking);
+		decaying = simd::ifelse(peaked, simd::float_4::mask(), simd::ifelse(finished, 0.f, decaying));
+		envLinear = simd::ifelse(peaked, 1.f, simd::ifelse(finished, 0.f, envLinear));
+		env = simd::ifelse(peaked | finished, envLinear, env);
+	}
+
+	/** Starts the attack for the masked lanes. `elapsed` is the time (in seconds) since the trigger actually occurred,
+	which the attack is advanced by, e.g. from SubSampleTrigger_4 for sub-sample accurate starts. */
+	void trigger(simd::float_4 mask, simd::float_4 elapsed = 0.f) {
+		if (!simd::movemask(mask)) {
+			return;
+		}
+		attacking = simd::ifelse(mask, simd::float_4::mask(), attacking);
+		decaying = simd::ifelse(mask, 0.f, decaying);
+		// non-linear envelopes won't retrigger at the correct starting point if
+		// attackShape != decayShape, so we advance the linear envelope
+		retriggerCurve.setShape(1.0f / attackShape);
+		envLinear = simd::ifelse(mask, retriggerCurve.process(env) + elapsed / attackTime, envLinear);
+	}
+
+	/** Switches the masked lanes off immediately */
+	void stop(simd::float_4 mask) {
+		attacking = simd::ifelse(mask, 0.f, attacking);
+		decaying = simd::ifelse(mask, 0.f, decaying);
+		envLinear = simd::ifelse(mask, 0.f, envLinear);
+		env = simd::ifelse(mask, 0.f, env);
+	}
+
+private:
+	simd::float_4 envLinear = 0.f;
+	PowerCurveTable attackCurve;
+	PowerCurveTable decayCurve;
+	// inverse of the attack curve
+	PowerCurveTable retriggerCurve;
 };
 
 // Creates a Butterworth 2*Nth order highpass filter for blocking DC
@@ -365,6 +496,54 @@ private:
 
 typedef DCBlockerT<2, float> DCBlocker;
 
+/** Trigger detector for float_4 lanes, with the hysteresis of dsp::TSchmittTrigger (by default, the 0.1V / 2V thresholds
+Rack modules use for triggers). As well as the rising edge itself, it estimates (by linear interpolation of the raw input)
+where between the previous and current sample the input crossed the high threshold, so that envelopes and oscillators can
+start (or reset) with sub-sample accuracy rather than jittering by up to a sample. */
+struct SubSampleTrigger_4 {
+	float lowThreshold, highThreshold;
+
+	SubSampleTrigger_4(float lowThreshold = 0.1f, float highThreshold = 2.f) : lowThreshold(lowThreshold), highThreshold(highThreshold) {}
+
+	/** Returns a mask of the lanes with a rising edge. For those, `fraction` is set to the crossing time as a fraction of
+	the sample period in (0, 1], measured from the previous sample (so 1 is the current sample). */
+	simd::float_4 process(simd::float_4 in, simd::float_4& fraction) {
+		const simd::float_4 high = in >= highThreshold;
+		const simd::float_4 triggered = simd::ifelse(state, 0.f, high);
+		state = simd::ifelse(high, simd::float_4::mask(), simd::ifelse(in <= lowThreshold, 0.f, state));
+
+		const simd::float_4 crossing = (highThreshold - previous) / (in - previous);
+		fraction = simd::ifelse(in > previous, simd::clamp(crossing, 1e-3f, 1.f), 1.f);
+		previous = in;
+		return triggered;
+	}
+
+	/** Time (in seconds) from the crossing to the current sample, for lanes which triggered on this sample */
+	static simd::float_4 getTimeSinceCrossing(simd::float_4 fraction, float sampleTime) {
+		return (1.f - fraction) * sampleTime;
+	}
+
+	simd::float_4 isHigh() const {
+		return state;
+	}
+
+	/** As with dsp::TSchmittTrigger, starts high, so that an input which is already high doesn't trigger */
+	void reset() {
+		state = simd::float_4::mask();
+		previous = INFINITY;
+	}
+
+private:
+	simd::float_4 state = simd::float_4::mask();
+	// no previous sample yet: an input can't be rising from here, so a first crossing is placed on the sample itself
+	simd::float_4 previous = INFINITY;
+};
+
+/** Hard sync edge detector, which applies the hysteresis of dsp::TSchmittTrigger to the raw input (low 0V, high 1V). */
+struct HardSync_4 : SubSampleTrigger_4 {
+	HardSync_4() : SubSampleTrigger_4(0.f, 1.f) {}
+};
+
 /** When triggered, holds a high value for a specified time before going low again */
 struct PulseGenerator_4 {
 	simd::float_4 remaining = 0.f;
@@ -390,6 +569,238 @@ struct PulseGenerator_4 {
 	}
 };
 
+/** A value computed at control rate, which is ramped linearly to each new target over the following block (rather
+than stepping) so that decimated parameters and CVs don't cause zipper noise. T is float or simd::float_4. */
+template <typename T = float>
+struct ControlRateRamp {
+	T value = 0.f;
+	T step = 0.f;
+	// false until the ramp has first been set to a value, so that it doesn't ramp up from 0
+	bool initialised = false;
+
+	void setTarget(T target, int numSamples) {
+		step = (target - value) / numSamples;
+	}
+
+	void jumpTo(T target) {
+		value = target;
+		step = 0.f;
+		initialised = true;
+	}
+
+	T process() {
+		value += step;
+		return value;
+	}
+};
+
+/** Decimation for the control-rate (parameter and CV) part of a module: process() returns true on the samples where
+control-rate values should be recomputed, i.e. every `division` samples. After a reset() (e.g. on sample rate change, or
+initially) the next update happens immediately, and ramps jump straight to their targets instead of interpolating.
+Ramps also jump on their own first update, e.g. for a polyphony group that has only just become active. */
+struct ControlRateDivider {
+
+	ControlRateDivider(int division = 16) {
+		setDivision(division);
+	}
+
+	void setDivision(int newDivision) {
+		division = newDivision;
+		divider.setDivision(division);
+	}
+
+	int getDivision() const {
+		return division;
+	}
+
+	/** Whether control-rate values should be updated on this sample */
+	bool process() {
+		jump = pendingJump;
+		pendingJump = false;
+		if (jump) {
+			// start a new block from this update
+			divider.reset();
+			return true;
+		}
+		return divider.process();
+	}
+
+	/** Forces an update (with jumps) on the next sample */
+	void reset() {
+		pendingJump = true;
+	}
+
+	/** During an update, sets the ramp's new target (which it reaches at the end of the block) */
+	template <typename T>
+	void setTarget(ControlRateRamp<T>& ramp, T target) const {
+		if (jump || !ramp.initialised) {
+			ramp.jumpTo(target);
+		}
+		else {
+			ramp.setTarget(target, division);
+		}
+	}
+
+private:
+	dsp::ClockDivider divider;
+	int division = 1;
+	bool pendingJump = true;
+	bool jump = false;
+};
+
+/** Clock that counts whole samples rather than accumulating floating point time, so it doesn't drift over long sets.
+It ticks every `period` samples, can be phase-locked to external events, and tracks the spacing of those events (e.g.
+pings or taps) so that modules can derive a tempo from them. */
+struct SampleClock {
+	int64_t period = 1;                 // samples between ticks
+	int64_t elapsed = 0;                // samples since the last tick (0 on the sample of a tick)
+	int64_t samplesSincePulse = 0;      // samples since the last external pulse
+
+	/** Registers an external pulse on the current sample, returns its spacing (in samples) from the previous one. */
+	int64_t pulse() {
+		const int64_t spacing = samplesSincePulse;
+		samplesSincePulse = 0;
+		return spacing;
+	}
+
+	/** Phase-locks to an event on the current sample: the next tick is a full period later. */
+	void sync() {
+		elapsed = -1;
+	}
+
+	/** Ticks on the current sample (and every period thereafter). */
+	void restart() {
+		elapsed = period - 1;
+	}
+
+	/** Advances by one sample, returns whether the clock ticks on it. */
+	bool process() {
+		samplesSincePulse++;
+		if (++elapsed >= period) {
+			elapsed = 0;
+			return true;
+		}
+		return false;
+	}
+
+	/** Rescales the period and pulse spacing (e.g. on a sample rate change), so the tempo in seconds is kept. */
+	void rescale(float ratio) {
+		period = std::max<int64_t>(std::round(period * ratio), 1);
+		elapsed = std::min<int64_t>(std::round(elapsed * ratio), period - 1);
+		samplesSincePulse = std::round(samplesSincePulse * ratio);
+	}
+};
+
+/** Generates a multiplied/divided version of an incoming clock, as a gate sequence. The incoming period is measured in
+whole samples, and the multiplied edges are placed at exact rational fractions of the divided period (rounded up to the
+next sample), so the output stays phase-locked to the input however long it runs. The sample of the next edge is
+computed in advance, so between edges process() only counts samples.
+Implementation is heavily inspired by BogAudio RGate, with modification */
+struct MultDivClock {
+
+	// convention: negative values are used for division (1/mult), positive for multiplication (x mult)
+	// multDiv = 0 should not be used, but if it is it will result in no modification to the clock
+	int multDiv = 1;
+	int64_t samplesSinceLastClock = -1;     // -1 until the first clock pulse
+	int64_t inputClockLength = -1;          // samples between the last two clock pulses, -1 until known
+
+	// count how many divisions we've had
+	int dividerCount = 0;
+	// samples since the start of the divided period
+	int64_t dividedProgress = 0;
+
+	/** Returns the gated clock signal (true when high), `sampleTime` sets the 1 ms minimum gate length. */
+	bool process(bool clockPulseReceived, float sampleTime) {
+
+		if (clockPulseReceived) {
+			// update our record of the incoming clock spacing
+			if (samplesSinceLastClock > 0) {
+				inputClockLength = samplesSinceLastClock;
+			}
+			samplesSinceLastClock = 0;
+		}
+
+		if (samplesSinceLastClock < 0) {
+			return false;
+		}
+		samplesSinceLastClock++;
+
+		if (clockPulseReceived) {
+			if (dividerCount < 1) {
+				dividedProgress = 0;
+			}
+			else {
+				dividedProgress++;
+			}
+			++dividerCount;
+			if (dividerCount >= getDivision()) {
+				dividerCount = 0;
+			}
+			// the clock length may have changed
+			scheduleEdges(sampleTime);
+		}
+		else {
+			dividedProgress++;
+		}
+
+		if (multDiv != scheduledMultDiv) {
+			scheduleEdges(sampleTime);
+		}
+
+		if (dividedProgress >= dividedLength) {
+			return false;
+		}
+		while (dividedProgress >= nextEdge) {
+			edge++;
+			edgeStart = nextEdge;
+			nextEdge = getEdgeSample(edge + 1);
+		}
+		return dividedProgress - edgeStart <= gateLength;
+	}
+
+	// negative values are used for division (x 1/mult), positive for multiplication (x mult)
+	int getDivision() const {
+		return std::max(-multDiv, 1);
+	}
+
+	int getMultiplication() const {
+		return std::max(multDiv, 1);
+	}
+
+	/** Length of the divided clock in samples (0 if not yet known), the multiplied clock is this / getMultiplication() */
+	int64_t getDividedClockLength() const {
+		return std::max<int64_t>(inputClockLength * getDivision(), 0);
+	}
+
+private:
+	int scheduledMultDiv = 1;
+	int64_t dividedLength = 0;      // length of the divided clock (samples)
+	int64_t gateLength = 0;         // length of the output gate (samples)
+	int64_t edge = 0;               // index of the current multiplied edge within the divided period
+	int64_t edgeStart = 0;          // sample (within the divided period) of the current multiplied edge
+	int64_t nextEdge = 0;           // sample of the next one
+
+	// multiplied edge k is on the first sample at or after k / multiplication of the divided period
+	int64_t getEdgeSample(int64_t k) const {
+		const int multiplication = getMultiplication();
+		return (k * dividedLength + multiplication - 1) / multiplication;
+	}
+
+	void scheduleEdges(float sampleTime) {
+		scheduledMultDiv = multDiv;
+		dividedLength = getDividedClockLength();
+		if (dividedLength == 0) {
+			return;
+		}
+
+		const int multiplication = getMultiplication();
+		edge = std::min<int64_t>(dividedProgress, dividedLength) * multiplication / dividedLength;
+		edgeStart = getEdgeSample(edge);
+		nextEdge = getEdgeSample(edge + 1);
+		gateLength = std::max(0.001f / sampleTime, 0.5f * dividedLength / multiplication);
+	}
+};
+
 // Zavalishin 2018, "The Art of VA Filter Design", http://www.native-instruments.com/fileadmin/ni_media/downloads/pdf/VAFilterDesign_2.0.0a.pdf
 // Section 6.7, adopted from BogAudio Saturator https://github.com/bogaudio/BogaudioModules/blob/master/src/dsp/signal.cpp
 template <class T>